@@ -1,83 +1,123 @@
+#ifndef ARRAY_CPP
+#define ARRAY_CPP
+
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <stdexcept>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 
-template <typename T, std::size_t Size> class array
+#define SIMD_NO_MAIN
+#include "simd.cpp"
+
+// Elements are stored inline; Alignment can be raised (e.g. 64 for a cache
+// line or AVX-512 vector) to align the start of the storage.
+template <typename T, std::size_t Size, std::size_t Alignment = alignof(T)>
+class array
 {
+    static_assert(
+        Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0,
+        "Alignment must be a power of two no smaller than alignof(T)"
+    );
+
 private:
-    T* m_ptr{ nullptr };
+    alignas(Alignment) T m_data[Size == 0 ? 1 : Size]{};
 
 public:
-    array()
-        : m_ptr{ new T[Size]{} }
+    constexpr array() = default;
+
+    // Each element is brace-initialised, so narrowing arguments are rejected
+    // just as they are for a built-in array. A single-element array is only
+    // constructed explicitly so that it is not an implicit conversion from T.
+    template <typename... Args>
+        requires(sizeof...(Args) == Size && Size != 0 &&
+                 (!std::is_same_v<std::remove_cvref_t<Args>, array> && ...) &&
+                 (requires { T{ std::declval<Args>() }; } && ...))
+    constexpr explicit(Size == 1) array(Args&&... args)
+        : m_data{ T{ std::forward<Args>(args) }... }
     {}
 
-    array(const array& other)
-        : m_ptr{ new T[Size]{} }
+    constexpr T&       operator[](std::size_t index) { return m_data[index]; }
+    constexpr const T& operator[](std::size_t index) const
     {
-        for (std::size_t i{ 0 }; i < Size; ++i)
-            m_ptr[i] = other.m_ptr[i];
+        return m_data[index];
     }
-
-    array& operator=(const array& other)
+    constexpr T& at(std::size_t index)
     {
-        if (this == &other)
-            return *this;
-
-        // Create a new array
-        T* new_ptr = new T[Size]{};
-
-        // Copy elements
-        for (std::size_t i{ 0 }; i < Size; ++i)
-            new_ptr[i] = other.m_ptr[i];
-
-        // Swap pointers (old memory not deleted until allocation succeeds)
-        std::swap(m_ptr, new_ptr);
-
-        // Delete old memory after
-        delete[] new_ptr;
-
-        return *this;
-    }
-
-    array(array&& other) noexcept
-        : m_ptr{ std::exchange(other.m_ptr, nullptr) }
-    {}
-
-    array& operator=(array&& other) noexcept
-    {
-        if (this == &other)
-            return *this;
-
-        m_ptr = std::exchange(other.m_ptr, nullptr);
-        return *this;
+        if (index >= Size)
+            throw std::out_of_range{ "Index out of range" };
+        return m_data[index];
     }
-
-    ~array() { delete[] m_ptr; }
-
-    T& operator[](std::size_t index) { return m_ptr[index]; }
-    T& at(std::size_t index) const
+    constexpr const T& at(std::size_t index) const
     {
         if (index >= Size)
             throw std::out_of_range{ "Index out of range" };
-        return m_ptr[index];
+        return m_data[index];
     }
-    void fill(const T& value)
+    // Arithmetic elements go through the SIMD kernels outside constant
+    // evaluation.
+    constexpr void fill(const T& value)
     {
+        if constexpr (simd::Element<T>)
+        {
+            if (!std::is_constant_evaluated())
+                return simd::fill(m_data, Size, value);
+        }
         for (std::size_t i{ 0 }; i < Size; ++i)
-            m_ptr[i] = value;
+            m_data[i] = value;
     }
-    const T&              front() const { return m_ptr[0]; }
-    const T&              back() const { return m_ptr[Size - 1]; }
-    T*                    data() { return m_ptr; }
-    const T*              data() const { return m_ptr; }
-    T*                    begin() { return m_ptr; }
-    T*                    end() { return m_ptr + Size; }
+    constexpr T&          front() { return m_data[0]; }
+    constexpr const T&    front() const { return m_data[0]; }
+    constexpr T&          back() { return m_data[Size - 1]; }
+    constexpr const T&    back() const { return m_data[Size - 1]; }
+    constexpr T*          data() { return m_data; }
+    constexpr const T*    data() const { return m_data; }
+    constexpr T*          begin() { return m_data; }
+    constexpr const T*    begin() const { return m_data; }
+    constexpr T*          end() { return m_data + Size; }
+    constexpr const T*    end() const { return m_data + Size; }
     constexpr std::size_t size() const { return Size; }
     constexpr bool        empty() const { return Size == 0; }
 };
 
+template <std::size_t I, typename T, std::size_t Size, std::size_t Alignment>
+constexpr T& get(array<T, Size, Alignment>& arr)
+{
+    static_assert(I < Size, "Index out of range");
+    return arr[I];
+}
+
+template <std::size_t I, typename T, std::size_t Size, std::size_t Alignment>
+constexpr const T& get(const array<T, Size, Alignment>& arr)
+{
+    static_assert(I < Size, "Index out of range");
+    return arr[I];
+}
+
+template <std::size_t I, typename T, std::size_t Size, std::size_t Alignment>
+constexpr T&& get(array<T, Size, Alignment>&& arr)
+{
+    static_assert(I < Size, "Index out of range");
+    return std::move(arr[I]);
+}
+
+template <typename T, std::size_t Size, std::size_t Alignment>
+struct std::tuple_size<array<T, Size, Alignment>>
+    : std::integral_constant<std::size_t, Size>
+{};
+
+template <std::size_t I, typename T, std::size_t Size, std::size_t Alignment>
+struct std::tuple_element<I, array<T, Size, Alignment>>
+{
+    using type = T;
+};
+
+#endif   // ARRAY_CPP
+
+#ifndef ARRAY_NO_MAIN
+
 int main()
 {
     bool allTestsPassed = true;
@@ -181,8 +221,8 @@ int main()
         temp.fill(33);
 
         array<int, 5> moved{ std::move(temp) };
-        // 'temp' is now in a valid but unspecified state (its pointer was
-        // moved). We'll check only that 'moved' has the data we expect.
+        // Elements are moved one by one; check that 'moved' has the data we
+        // expect.
         for (std::size_t i = 0; i < moved.size(); ++i)
         {
             check(
@@ -248,6 +288,52 @@ int main()
         check(emptyArr.size() == 0, "size() should be 0 for array<int,0>");
     }
 
+    // 10) Test inline storage, alignment and trivial copyability
+    {
+        static_assert(sizeof(array<int, 5>) == 5 * sizeof(int));
+        static_assert(std::is_trivially_copyable_v<array<int, 5>>);
+        static_assert(alignof(array<float, 16, 64>) == 64);
+
+        array<float, 16, 64> arr;
+        check(
+            reinterpret_cast<std::uintptr_t>(arr.data()) % 64 == 0,
+            "data() should honour the requested alignment"
+        );
+    }
+
+    // 11) Test constexpr usage
+    {
+        constexpr auto squares = []
+        {
+            array<int, 4> arr;
+            for (std::size_t i = 0; i < arr.size(); ++i)
+                arr[i] = static_cast<int>(i * i);
+            return arr;
+        }();
+        static_assert(squares[3] == 9, "array should be usable in constexpr");
+
+        constexpr array<int, 3> values{ 1, 2, 3 };
+        static_assert(values.front() == 1 && values.back() == 3);
+
+        // Narrowing is rejected, and one element never converts implicitly.
+        static_assert(std::is_constructible_v<array<int, 2>, int, short>);
+        static_assert(!std::is_constructible_v<array<int, 2>, int, double>);
+        static_assert(!std::is_constructible_v<array<char, 1>, int>);
+        static_assert(std::is_constructible_v<array<int, 1>, int>);
+        static_assert(!std::is_convertible_v<int, array<int, 1>>);
+    }
+
+    // 12) Test tuple interface and structured bindings
+    {
+        array<int, 3> arr{ 7, 8, 9 };
+        auto& [a, b, c] = arr;
+        check(a == 7 && b == 8 && c == 9, "structured bindings should work");
+
+        b = 80;
+        check(get<1>(arr) == 80, "get<I>() should return a reference");
+        static_assert(std::tuple_size_v<array<int, 3>> == 3);
+    }
+
     // Report summary
     if (allTestsPassed)
     {
@@ -260,3 +346,5 @@ int main()
 
     return 0;
 }
+
+#endif   // ARRAY_NO_MAIN
@@ -0,0 +1,299 @@
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Append-only vector shared by concurrent writers and readers.
+//
+// Elements live in segments that double in size and are never moved, so
+// references stay valid for the lifetime of the container. push_back makes
+// sure the next slot's segment exists, then claims the slot with a CAS on
+// the reserved count; once the element is constructed the slot is marked
+// ready and the published size is advanced over every ready slot
+// (any writer may advance it on behalf of others). Readers only look at
+// indices below size(), all of which are fully constructed.
+template <class T, size_t FirstSegment = 64>
+class ConcurrentVector
+{
+    static_assert(
+        std::has_single_bit(FirstSegment),
+        "FirstSegment must be a power of two"
+    );
+
+private:
+    struct Slot
+    {
+        alignas(T) unsigned char storage[sizeof(T)];
+        std::atomic<bool>        ready{ false };
+
+        T* get() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    // Segment 0 holds FirstSegment slots and segment k > 0 holds
+    // FirstSegment << (k - 1), so segments 0..k cover FirstSegment << k.
+    static constexpr size_t max_segments = 48;
+
+    std::atomic<Slot*>               m_segments[max_segments]{};
+    alignas(64) std::atomic<size_t> m_reserved{ 0 };
+    alignas(64) std::atomic<size_t> m_published{ 0 };
+
+    static size_t segment_of(size_t index)
+    {
+        return std::bit_width(index / FirstSegment);
+    }
+
+    static size_t segment_base(size_t segment)
+    {
+        return segment == 0 ? 0 : FirstSegment << (segment - 1);
+    }
+
+    static size_t segment_size(size_t segment)
+    {
+        return segment == 0 ? FirstSegment : FirstSegment << (segment - 1);
+    }
+
+    Slot* segment(size_t k)
+    {
+        Slot* current = m_segments[k].load(std::memory_order_acquire);
+        if (current)
+            return current;
+
+        // Racing writers may both allocate; the loser frees its copy.
+        Slot* fresh = new Slot[segment_size(k)];
+        if (m_segments[k].compare_exchange_strong(
+                current, fresh, std::memory_order_acq_rel,
+                std::memory_order_acquire
+            ))
+            return fresh;
+
+        delete[] fresh;
+        return current;
+    }
+
+    Slot& slot(size_t index)
+    {
+        size_t k = segment_of(index);
+        return segment(k)[index - segment_base(k)];
+    }
+
+    bool is_ready(size_t index) const
+    {
+        size_t k   = segment_of(index);
+        Slot*  seg = m_segments[k].load(std::memory_order_acquire);
+        return seg && seg[index - segment_base(k)].ready.load();
+    }
+
+    // Constructing T must not throw: an abandoned slot would stop
+    // publication for good, so a throwing constructor terminates.
+    template <class... Args>
+    static void construct(Slot& target, Args&&... args) noexcept
+    {
+        new (target.storage) T(std::forward<Args>(args)...);
+        target.ready.store(true);
+    }
+
+    void publish()
+    {
+        size_t size = m_published.load(std::memory_order_acquire);
+        while (size < m_reserved.load(std::memory_order_acquire) &&
+               is_ready(size))
+        {
+            // On failure size is reloaded and the loop re-checks it.
+            m_published.compare_exchange_weak(
+                size, size + 1, std::memory_order_acq_rel,
+                std::memory_order_acquire
+            );
+        }
+    }
+
+public:
+    class Iterator
+    {
+    private:
+        ConcurrentVector* m_vector;
+        size_t            m_index;
+
+    public:
+        Iterator(ConcurrentVector* vector, size_t index)
+            : m_vector{ vector }, m_index{ index }
+        {}
+
+        T&        operator*() const { return (*m_vector)[m_index]; }
+        T*        operator->() const { return &(*m_vector)[m_index]; }
+        Iterator& operator++()
+        {
+            ++m_index;
+            return *this;
+        }
+        bool operator==(const Iterator& other) const
+        {
+            return m_index == other.m_index;
+        }
+    };
+
+    ConcurrentVector() = default;
+    ConcurrentVector(const ConcurrentVector&)            = delete;
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+    ~ConcurrentVector();
+
+    // Throws std::length_error past max_size and std::bad_alloc if the
+    // slot's segment cannot be allocated; either way before a slot is
+    // claimed, so the vector is unchanged.
+    template <class... Args>
+    size_t emplace_back(Args&&... args);
+    size_t push_back(const T& value) { return emplace_back(value); }
+    void   reserve(size_t capacity);
+
+    // Number of elements safe to read; only grows.
+    size_t size() const { return m_published.load(std::memory_order_acquire); }
+
+    // Elements that fit in all max_segments segments.
+    static constexpr size_t max_size =
+        FirstSegment > (SIZE_MAX >> (max_segments - 1))
+            ? SIZE_MAX
+            : FirstSegment << (max_segments - 1);
+
+    T& operator[](size_t index)
+    {
+        assert(index < size());
+        return *slot(index).get();
+    }
+
+    // Iterates over the elements published when end() was called.
+    Iterator begin() { return { this, 0 }; }
+    Iterator end() { return { this, size() }; }
+};
+
+template <typename T, size_t FirstSegment>
+ConcurrentVector<T, FirstSegment>::~ConcurrentVector()
+{
+    size_t count = m_reserved.load(std::memory_order_acquire);
+    for (size_t i{ 0 }; i < count; ++i)
+        slot(i).get()->~T();
+
+    for (auto& seg : m_segments)
+        delete[] seg.load(std::memory_order_relaxed);
+}
+
+template <typename T, size_t FirstSegment>
+template <typename... Args>
+size_t ConcurrentVector<T, FirstSegment>::emplace_back(Args&&... args)
+{
+    size_t index = m_reserved.load(std::memory_order_relaxed);
+    do
+    {
+        if (index >= max_size)
+            throw std::length_error{ "ConcurrentVector is full" };
+        segment(segment_of(index));
+    } while (!m_reserved.compare_exchange_weak(
+        index, index + 1, std::memory_order_acq_rel, std::memory_order_relaxed
+    ));
+
+    construct(slot(index), std::forward<Args>(args)...);
+    publish();
+    return index;
+}
+
+// Allocates segments up front so later appends never hit the allocator.
+template <typename T, size_t FirstSegment>
+void ConcurrentVector<T, FirstSegment>::reserve(size_t capacity)
+{
+    if (capacity == 0)
+        return;
+    if (capacity > max_size)
+        throw std::length_error{ "ConcurrentVector capacity too large" };
+
+    for (size_t k{ 0 }; k <= segment_of(capacity - 1); ++k)
+        segment(k);
+}
+
+int main()
+{
+    // Single-threaded basics
+    {
+        ConcurrentVector<std::string, 2> v;
+        for (int i = 0; i < 20; ++i)
+            assert(v.push_back(std::to_string(i)) == static_cast<size_t>(i));
+        assert(v.size() == 20);
+        assert(v[0] == "0" && v[19] == "19");
+
+        // Element addresses survive later growth
+        std::string* first = &v[0];
+        for (int i = 0; i < 1000; ++i)
+            v.emplace_back("x");
+        assert(&v[0] == first);
+
+        size_t count = 0;
+        for (auto& value : v)
+            count += value.empty() ? 0 : 1;
+        assert(count == 1020);
+
+        // Oversized requests throw instead of overrunning the segment table
+        bool threw = false;
+        try
+        {
+            v.reserve(decltype(v)::max_size + 1);
+        }
+        catch (const std::length_error&)
+        {
+            threw = true;
+        }
+        assert(threw && v.size() == 1020);
+    }
+
+    // Concurrent writers with a concurrent reader
+    {
+        constexpr int             writers   = 4;
+        constexpr int             perWriter = 20000;
+        ConcurrentVector<int>     v;
+        std::atomic<bool>         done{ false };
+        std::vector<std::thread> threads;
+
+        v.reserve(1000);
+        for (int w = 0; w < writers; ++w)
+        {
+            threads.emplace_back(
+                [&, w]
+                {
+                    for (int i = 0; i < perWriter; ++i)
+                        v.push_back(w * perWriter + i);
+                }
+            );
+        }
+
+        std::thread reader(
+            [&]
+            {
+                while (!done.load())
+                {
+                    size_t size = v.size();
+                    for (size_t i = 0; i < size; ++i)
+                        assert(v[i] >= 0 && v[i] < writers * perWriter);
+                }
+            }
+        );
+
+        for (auto& thread : threads)
+            thread.join();
+        done = true;
+        reader.join();
+
+        assert(v.size() == static_cast<size_t>(writers * perWriter));
+        std::vector<bool> seen(writers * perWriter);
+        for (int value : v)
+            seen[value] = true;
+        for (bool found : seen)
+            assert(found);
+    }
+
+    std::cout << "All tests passed.\n";
+    return 0;
+}
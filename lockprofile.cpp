@@ -0,0 +1,708 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "semaphore.cpp"
+
+// Opt-in contention profiling for Mutex, SharedMutex, CountSemaphore and
+// AwaitNotifySemaphore. Declare a lock as Profiled<Lock> with a name tag
+// and it keeps the lock's interface. When the build defines
+// LOCK_PROFILING, each Profiled lock counts acquisitions and contended
+// acquisitions, keeps log-bucketed histograms of wait and hold times and
+// remembers its longest waiter; snapshot_lock_profiles() and the dump
+// functions read every live lock. Without the flag Profiled<Lock> is the
+// bare lock, the name is dropped and the snapshot is empty.
+//
+// An acquire that succeeds on its first try counts as uncontended and
+// reads no clock. Shared acquisitions of a SharedMutex are counted and
+// their waits timed along with the exclusive ones. Hold times are only
+// kept for exclusive holds, because semaphore permits are often released
+// by another thread and shared holds overlap. One exclusive hold in
+// hold_sample_period is timed, contended or not, so that the clock reads
+// stay within budget and the hold histogram is an unbiased sample.
+
+// Log-bucketed histogram in the style of HdrHistogram: each power of two
+// is split into sub_buckets linear steps, so a bucket's width stays
+// within 25% of its value across the full 64-bit range.
+struct LatencyHistogram
+{
+    struct Bucket
+    {
+        uint64_t lower_ns;
+        uint64_t count;
+    };
+
+    std::vector<Bucket> buckets;   // Non-empty buckets, ascending
+    uint64_t            count{ 0 };
+
+    // Lower bound of the bucket holding the given fraction of samples.
+    uint64_t percentile(double fraction) const
+    {
+        uint64_t rank = static_cast<uint64_t>(fraction * count);
+        uint64_t seen = 0;
+        for (const Bucket& bucket : buckets)
+        {
+            seen += bucket.count;
+            if (seen > rank)
+                return bucket.lower_ns;
+        }
+        return buckets.empty() ? 0 : buckets.back().lower_ns;
+    }
+};
+
+struct LockProfile
+{
+    std::string      name;
+    uint64_t         acquisitions{ 0 };
+    uint64_t         contended{ 0 };
+    uint64_t         longest_wait_ns{ 0 };
+    size_t           longest_waiter{ 0 };   // std::hash of the thread id
+    LatencyHistogram wait;
+    LatencyHistogram hold;
+};
+
+#ifdef LOCK_PROFILING
+
+namespace lock_profiling
+{
+
+// Timestamps are raw cycle counts where available, since a clock read on
+// every acquire and release must stay cheap; they are converted to
+// nanoseconds only when a snapshot is taken.
+inline uint64_t now_ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()
+    )
+        .count();
+#endif
+}
+
+inline double nanoseconds_per_tick()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    static const double ratio = []
+    {
+        using namespace std::chrono;
+        auto     start      = steady_clock::now();
+        uint64_t startTicks = now_ticks();
+        while (steady_clock::now() - start < milliseconds(10))
+            cpu_relax();
+        double elapsed = static_cast<double>(
+            duration_cast<nanoseconds>(steady_clock::now() - start).count()
+        );
+        return elapsed / static_cast<double>(now_ticks() - startTicks);
+    }();
+    return ratio;
+#else
+    return 1.0;
+#endif
+}
+
+class Histogram
+{
+public:
+    static constexpr unsigned sub_bits    = 2;
+    static constexpr unsigned sub_buckets = 1u << sub_bits;
+    static constexpr size_t   bucket_count =
+        sub_buckets * (64 - sub_bits + 1);
+
+    static size_t index(uint64_t value)
+    {
+        if (value < sub_buckets)
+            return static_cast<size_t>(value);
+        unsigned exponent = std::bit_width(value) - 1;
+        unsigned shift    = exponent - sub_bits;
+        return sub_buckets * (shift + 1) +
+               static_cast<size_t>((value >> shift) & (sub_buckets - 1));
+    }
+
+    static uint64_t lower_bound(size_t index)
+    {
+        if (index < sub_buckets)
+            return index;
+        unsigned shift = static_cast<unsigned>(index / sub_buckets) - 1;
+        return (sub_buckets + index % sub_buckets) << shift;
+    }
+
+    template <bool Exclusive>
+    void record(uint64_t ticks)
+    {
+        add<Exclusive>(m_counts[index(ticks)], 1);
+    }
+
+    LatencyHistogram snapshot(double nsPerTick) const
+    {
+        LatencyHistogram result;
+        for (size_t i = 0; i < bucket_count; ++i)
+        {
+            uint64_t count = m_counts[i].load(std::memory_order_relaxed);
+            if (count == 0)
+                continue;
+            result.buckets.push_back(
+                { static_cast<uint64_t>(lower_bound(i) * nsPerTick), count }
+            );
+            result.count += count;
+        }
+        return result;
+    }
+
+    // Counters touched only by the lock holder need no locked instruction.
+    template <bool Exclusive>
+    static void add(std::atomic<uint64_t>& counter, uint64_t n)
+    {
+        if constexpr (Exclusive)
+            counter.store(
+                counter.load(std::memory_order_relaxed) + n,
+                std::memory_order_relaxed
+            );
+        else
+            counter.fetch_add(n, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> m_counts[bucket_count]{};
+};
+
+// Counters for one named lock. Every live LockStats is linked into a
+// registry so a snapshot can find it.
+class LockStats
+{
+public:
+    explicit LockStats(std::string name)
+        : m_name{ std::move(name) }
+    {
+        std::lock_guard lock{ registry_mutex() };
+        registry().push_back(this);
+    }
+    LockStats(const LockStats&)            = delete;
+    LockStats& operator=(const LockStats&) = delete;
+
+    ~LockStats()
+    {
+        std::lock_guard lock{ registry_mutex() };
+        auto&           all = registry();
+        all.erase(std::find(all.begin(), all.end(), this));
+    }
+
+    template <bool Exclusive>
+    void acquired(uint64_t waitTicks, uint64_t n = 1)
+    {
+        Histogram::add<Exclusive>(m_acquisitions, n);
+        if (waitTicks == 0)
+            return;
+
+        Histogram::add<Exclusive>(m_contended, n);
+        m_wait.record<Exclusive>(waitTicks);
+
+        uint64_t longest = m_longestWait.load(std::memory_order_relaxed);
+        while (waitTicks > longest)
+        {
+            if (m_longestWait.compare_exchange_weak(
+                    longest, waitTicks, std::memory_order_relaxed
+                ))
+            {
+                m_longestWaiter.store(
+                    std::hash<std::thread::id>{}(std::this_thread::get_id()),
+                    std::memory_order_relaxed
+                );
+                break;
+            }
+        }
+    }
+
+    void held(uint64_t ticks) { m_hold.record<true>(ticks); }
+
+    LockProfile snapshot(double nsPerTick) const
+    {
+        LockProfile profile;
+        profile.name         = m_name;
+        profile.acquisitions = m_acquisitions.load(std::memory_order_relaxed);
+        profile.contended    = m_contended.load(std::memory_order_relaxed);
+        profile.longest_wait_ns = static_cast<uint64_t>(
+            m_longestWait.load(std::memory_order_relaxed) * nsPerTick
+        );
+        profile.longest_waiter =
+            m_longestWaiter.load(std::memory_order_relaxed);
+        profile.wait = m_wait.snapshot(nsPerTick);
+        profile.hold = m_hold.snapshot(nsPerTick);
+        return profile;
+    }
+
+    static std::vector<LockProfile> snapshot_all()
+    {
+        double                   nsPerTick = nanoseconds_per_tick();
+        std::vector<LockProfile> result;
+        std::lock_guard          lock{ registry_mutex() };
+        for (const LockStats* stats : registry())
+            result.push_back(stats->snapshot(nsPerTick));
+        return result;
+    }
+
+private:
+    std::string                       m_name;
+    alignas(64) std::atomic<uint64_t> m_acquisitions{ 0 };
+    std::atomic<uint64_t>             m_contended{ 0 };
+    std::atomic<uint64_t>             m_longestWait{ 0 };
+    std::atomic<size_t>               m_longestWaiter{ 0 };
+    Histogram                         m_wait;
+    Histogram                         m_hold;
+
+    static std::mutex& registry_mutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static std::vector<LockStats*>& registry()
+    {
+        static std::vector<LockStats*> all;
+        return all;
+    }
+};
+
+}   // namespace lock_profiling
+
+template <typename Lock>
+class Profiled : public Lock
+{
+public:
+    template <typename... Args>
+    explicit Profiled(std::string name, Args&&... args)
+        : Lock(std::forward<Args>(args)...),
+          m_stats{ std::move(name) }
+    {}
+
+    static constexpr uint32_t hold_sample_period = 8;
+
+    // Exclusive locks: lock/unlock/try_lock
+    void lock()
+        requires requires(Lock& l) { l.lock(); }
+    {
+        if (Lock::try_lock())
+        {
+            m_stats.template acquired<true>(0);
+            m_acquiredAt = sample_hold();
+            return;
+        }
+
+        uint64_t start = now();
+        Lock::lock();
+        uint64_t acquiredAt = now();
+        m_stats.template acquired<true>(waited(start, acquiredAt));
+        m_acquiredAt = take_hold_sample() ? acquiredAt : 0;
+    }
+
+    bool try_lock()
+        requires requires(Lock& l) { l.try_lock(); }
+    {
+        if (!Lock::try_lock())
+            return false;
+        m_stats.template acquired<true>(0);
+        m_acquiredAt = sample_hold();
+        return true;
+    }
+
+    void unlock()
+        requires requires(Lock& l) { l.unlock(); }
+    {
+        if (m_acquiredAt != 0)
+            m_stats.held(now() - m_acquiredAt);
+        Lock::unlock();
+    }
+
+    // Shared locks: lock_shared/try_lock_shared/unlock_shared
+    void lock_shared()
+        requires requires(Lock& l) { l.lock_shared(); }
+    {
+        if (Lock::try_lock_shared())
+        {
+            m_stats.template acquired<false>(0);
+            return;
+        }
+
+        uint64_t start = now();
+        Lock::lock_shared();
+        m_stats.template acquired<false>(waited(start, now()));
+    }
+
+    bool try_lock_shared()
+        requires requires(Lock& l) { l.try_lock_shared(); }
+    {
+        if (!Lock::try_lock_shared())
+            return false;
+        m_stats.template acquired<false>(0);
+        return true;
+    }
+
+    // Semaphores: acquire/try_acquire and friends
+    void acquire()
+        requires requires(Lock& l) { l.acquire(); }
+    {
+        if (Lock::try_acquire())
+        {
+            m_stats.template acquired<false>(0);
+            return;
+        }
+
+        uint64_t start = now();
+        Lock::acquire();
+        m_stats.template acquired<false>(waited(start, now()));
+    }
+
+    void acquire_many(uint32_t n)
+        requires requires(Lock& l) { l.acquire_many(n); }
+    {
+        if (Lock::try_acquire_many(n))
+        {
+            m_stats.template acquired<false>(0, n);
+            return;
+        }
+
+        uint64_t start = now();
+        Lock::acquire_many(n);
+        m_stats.template acquired<false>(waited(start, now()), n);
+    }
+
+    bool try_acquire()
+        requires requires(Lock& l) { l.try_acquire(); }
+    {
+        if (!Lock::try_acquire())
+            return false;
+        m_stats.template acquired<false>(0);
+        return true;
+    }
+
+    bool try_acquire_many(uint32_t n)
+        requires requires(Lock& l) { l.try_acquire_many(n); }
+    {
+        if (!Lock::try_acquire_many(n))
+            return false;
+        m_stats.template acquired<false>(0, n);
+        return true;
+    }
+
+    template <typename Rep, typename Period>
+    bool try_acquire_for(const std::chrono::duration<Rep, Period>& timeout)
+        requires requires(Lock& l) { l.try_acquire_for(timeout); }
+    {
+        return try_acquire_until(std::chrono::steady_clock::now() + timeout);
+    }
+
+    template <typename Clock, typename Duration>
+    bool try_acquire_until(
+        const std::chrono::time_point<Clock, Duration>& deadline
+    )
+        requires requires(Lock& l) { l.try_acquire_until(deadline); }
+    {
+        if (Lock::try_acquire())
+        {
+            m_stats.template acquired<false>(0);
+            return true;
+        }
+
+        uint64_t start = now();
+        if (!Lock::try_acquire_until(deadline))
+            return false;
+        m_stats.template acquired<false>(waited(start, now()));
+        return true;
+    }
+
+private:
+    lock_profiling::LockStats m_stats;
+    // Written and read only by the thread holding an exclusive lock; a
+    // zero acquiredAt means this hold is not timed.
+    uint64_t m_acquiredAt{ 0 };
+    uint32_t m_holds{ 0 };
+
+    static uint64_t now() { return lock_profiling::now_ticks(); }
+
+    bool take_hold_sample() { return ++m_holds % hold_sample_period == 0; }
+
+    uint64_t sample_hold() { return take_hold_sample() ? now() : 0; }
+
+    // A contended acquire always records a nonzero wait.
+    static uint64_t waited(uint64_t start, uint64_t end)
+    {
+        return std::max<uint64_t>(end - start, 1);
+    }
+};
+
+inline std::vector<LockProfile> snapshot_lock_profiles()
+{
+    return lock_profiling::LockStats::snapshot_all();
+}
+
+#else
+
+// Profiling disabled: the lock itself, with the name tag accepted and
+// dropped.
+template <typename Lock>
+class Profiled : public Lock
+{
+public:
+    template <typename... Args>
+    explicit Profiled(const std::string&, Args&&... args)
+        : Lock(std::forward<Args>(args)...)
+    {}
+};
+
+inline std::vector<LockProfile> snapshot_lock_profiles() { return {}; }
+
+#endif   // LOCK_PROFILING
+
+inline void dump_lock_profiles_text(std::ostream& out)
+{
+    for (const LockProfile& profile : snapshot_lock_profiles())
+    {
+        out << profile.name << ": " << profile.acquisitions
+            << " acquisitions, " << profile.contended << " contended\n"
+            << "  wait ns p50 " << profile.wait.percentile(0.5) << " p99 "
+            << profile.wait.percentile(0.99) << " longest "
+            << profile.longest_wait_ns << " (thread " << profile.longest_waiter
+            << ")\n"
+            << "  hold ns p50 " << profile.hold.percentile(0.5) << " p99 "
+            << profile.hold.percentile(0.99) << '\n';
+    }
+}
+
+inline void dump_lock_profiles_json(std::ostream& out)
+{
+    auto quoted = [&out](const std::string& text)
+    {
+        out << '"';
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                out << '\\' << c;
+            else if (static_cast<unsigned char>(c) < 0x20)
+                out << "\\u00" << "0123456789abcdef"[c >> 4]
+                    << "0123456789abcdef"[c & 0xf];
+            else
+                out << c;
+        }
+        out << '"';
+    };
+    auto histogram = [&out](const LatencyHistogram& h)
+    {
+        out << "{\"count\":" << h.count << ",\"buckets\":[";
+        for (size_t i = 0; i < h.buckets.size(); ++i)
+        {
+            out << (i ? "," : "") << '[' << h.buckets[i].lower_ns << ','
+                << h.buckets[i].count << ']';
+        }
+        out << "]}";
+    };
+
+    out << '[';
+    bool first = true;
+    for (const LockProfile& profile : snapshot_lock_profiles())
+    {
+        out << (first ? "" : ",") << "{\"name\":";
+        quoted(profile.name);
+        out << ",\"acquisitions\":" << profile.acquisitions
+            << ",\"contended\":" << profile.contended
+            << ",\"longest_wait_ns\":" << profile.longest_wait_ns
+            << ",\"longest_waiter\":" << profile.longest_waiter
+            << ",\"wait\":";
+        histogram(profile.wait);
+        out << ",\"hold\":";
+        histogram(profile.hold);
+        out << '}';
+        first = false;
+    }
+    out << "]\n";
+}
+
+int main()
+{
+    // The wrappers keep each lock's interface
+    {
+        Profiled<Mutex> mutex{ "mutex" };
+        {
+            std::lock_guard lock{ mutex };
+        }
+        assert(mutex.try_lock());
+        mutex.unlock();
+
+        Profiled<CountSemaphore> permits{ "permits", 4u };
+        permits.acquire_many(3);
+        assert(permits.try_acquire());
+        assert(!permits.try_acquire_for(std::chrono::milliseconds(1)));
+        permits.release(4);
+
+        Profiled<AwaitNotifySemaphore> signal{ "signal" };
+        signal.acquire();
+        assert(!signal.try_acquire());
+        signal.release();
+
+        Profiled<SharedMutex> table{ "table" };
+        table.lock_shared();
+        assert(table.try_lock_shared());
+        assert(!table.try_lock());
+        table.unlock_shared();
+        table.unlock_shared();
+        std::lock_guard lock{ table };
+    }
+
+#ifdef LOCK_PROFILING
+    // Contended acquisitions are counted and timed
+    {
+        Profiled<Mutex>          mutex{ "counter" };
+        Profiled<CountSemaphore> permits{ "permits", 2u };
+        long                     counter = 0;
+
+        // Force one contended acquire of each: main holds the lock (or
+        // every permit) until the other thread has had time to block on it.
+        std::atomic<bool> started{ false };
+        auto              blockOn = [&](auto take, auto give)
+        {
+            started = false;
+            std::thread waiter(
+                [&started, take, give]
+                {
+                    started = true;
+                    take();
+                    give();
+                }
+            );
+            while (!started)
+                std::this_thread::yield();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            return waiter;
+        };
+
+        mutex.lock();
+        std::thread mutexWaiter = blockOn(
+            [&] { mutex.lock(); },
+            [&]
+            {
+                ++counter;
+                mutex.unlock();
+            }
+        );
+        size_t mutexWaiterId =
+            std::hash<std::thread::id>{}(mutexWaiter.get_id());
+        mutex.unlock();
+        mutexWaiter.join();
+
+        permits.acquire_many(2);
+        std::thread permitsWaiter =
+            blockOn([&] { permits.acquire(); }, [&] { permits.release(); });
+        size_t permitsWaiterId =
+            std::hash<std::thread::id>{}(permitsWaiter.get_id());
+        permits.release(2);
+        permitsWaiter.join();
+
+        auto profiles = snapshot_lock_profiles();
+        assert(profiles.size() == 2);
+        assert(profiles[0].acquisitions == 2);   // main, then the waiter
+        assert(profiles[1].acquisitions == 3);   // Two permits, then one
+        for (const LockProfile& profile : profiles)
+        {
+            assert(profile.contended == 1 && profile.wait.count == 1);
+            assert(profile.longest_wait_ns > 0);
+        }
+        assert(profiles[0].longest_waiter == mutexWaiterId);
+        assert(profiles[1].longest_waiter == permitsWaiterId);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back(
+                [&]
+                {
+                    for (int i = 0; i < 10000; ++i)
+                    {
+                        {
+                            std::lock_guard lock{ mutex };
+                            ++counter;
+                        }
+                        permits.acquire();
+                        permits.release();
+                    }
+                }
+            );
+        }
+        for (auto& thread : threads)
+            thread.join();
+        assert(counter == 40001);
+
+        profiles = snapshot_lock_profiles();
+        assert(profiles[0].acquisitions == 40002);
+        assert(profiles[1].acquisitions == 40003);
+        for (const LockProfile& profile : profiles)
+        {
+            assert(profile.contended >= 1);
+            assert(profile.contended <= profile.acquisitions);
+            assert(profile.wait.count == profile.contended);
+        }
+        uint64_t sampled = 40002 / Profiled<Mutex>::hold_sample_period;
+        assert(profiles[0].hold.count == sampled);
+        assert(profiles[1].hold.count == 0);
+
+        dump_lock_profiles_text(std::cout);
+        dump_lock_profiles_json(std::cout);
+    }
+
+    // Shared acquisitions are counted, and names are escaped in JSON
+    {
+        Profiled<SharedMutex> table{ "table\t\"v1\"\n" };
+        table.lock_shared();
+        assert(table.try_lock_shared());
+        table.unlock_shared();
+        table.unlock_shared();
+        table.lock();
+        table.unlock();
+
+        auto profiles = snapshot_lock_profiles();
+        assert(profiles.size() == 1 && profiles[0].acquisitions == 3);
+
+        std::ostringstream json;
+        dump_lock_profiles_json(json);
+        assert(
+            json.str().find(R"("name":"table\u0009\"v1\"\u000a")") !=
+            std::string::npos
+        );
+    }
+
+    // Histogram buckets stay within a quarter of their value
+    {
+        using lock_profiling::Histogram;
+        for (uint64_t value : { 0ull, 3ull, 4ull, 7ull, 1000ull, ~0ull })
+        {
+            size_t index = Histogram::index(value);
+            assert(index < Histogram::bucket_count);
+            assert(Histogram::lower_bound(index) <= value);
+            assert(value - Histogram::lower_bound(index) <= value / 4);
+        }
+    }
+#else
+    // Disabled, a profiled lock is the bare lock
+    static_assert(sizeof(Profiled<Mutex>) == sizeof(Mutex));
+    assert(snapshot_lock_profiles().empty());
+#endif
+
+    std::cout << "All tests passed.\n";
+    return 0;
+}
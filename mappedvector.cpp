@@ -0,0 +1,378 @@
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+
+inline std::uint64_t fnv1a(const void* data, size_t bytes)
+{
+    auto          ptr  = static_cast<const unsigned char*>(data);
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i{ 0 }; i < bytes; ++i)
+        hash = (hash ^ ptr[i]) * 0x100000001b3ull;
+    return hash;
+}
+
+// Identifies the element type stored in a file. The default hashes the
+// compiler's spelling of T, which is stable for a given toolchain;
+// specialize it to pin a tag that survives renames or compiler changes.
+template <class T>
+struct MappedTypeTag
+{
+    static std::uint64_t value()
+    {
+        return fnv1a(__PRETTY_FUNCTION__, std::strlen(__PRETTY_FUNCTION__));
+    }
+};
+
+// On-disk header; elements start at data_offset.
+struct MappedHeader
+{
+    char          magic[8];
+    std::uint64_t type_tag;
+    std::uint64_t element_size;
+    std::uint64_t size;
+    std::uint64_t checksum;   // Of the element bytes, as of the last flush
+};
+
+// Vector of trivially copyable elements living in an mmap'd file. Opening
+// an existing file maps it in place (constant time, nothing is copied or
+// checked beyond the header); growth extends the file with ftruncate and
+// remaps it. Changes reach the file through the page cache; flush()
+// refreshes the checksum and forces them to disk with msync.
+template <class T>
+class MappedVector
+{
+    static_assert(
+        std::is_trivially_copyable_v<T>,
+        "MappedVector stores raw bytes and needs trivially copyable T"
+    );
+
+public:
+    static constexpr size_t data_offset = 64;
+    static_assert(alignof(T) <= data_offset && sizeof(MappedHeader) <= 64);
+
+private:
+    static constexpr char magic[8] = { 'M', 'A', 'P', 'V', 'E', 'C', '0', '1' };
+
+    int    m_fd{ -1 };
+    void*  m_map{ nullptr };
+    size_t m_length{ 0 };   // Bytes mapped, equal to the file size
+    T*     m_data{ nullptr };
+
+    MappedHeader* header()
+    {
+        assert(m_map && "MappedVector has been moved from");
+        return static_cast<MappedHeader*>(m_map);
+    }
+    const MappedHeader* header() const
+    {
+        assert(m_map && "MappedVector has been moved from");
+        return static_cast<const MappedHeader*>(m_map);
+    }
+
+    [[noreturn]] static void fail(const char* what)
+    {
+        throw std::system_error{ errno, std::generic_category(), what };
+    }
+
+    void map(size_t length)
+    {
+        void* ptr =
+            mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+        if (ptr == MAP_FAILED)
+            fail("mmap");
+
+        m_map    = ptr;
+        m_length = length;
+        m_data   = reinterpret_cast<T*>(static_cast<char*>(ptr) + data_offset);
+    }
+
+    void remap(size_t length)
+    {
+        if (ftruncate(m_fd, static_cast<off_t>(length)) != 0)
+            fail("ftruncate");
+
+#ifdef __linux__
+        void* ptr = mremap(m_map, m_length, length, MREMAP_MAYMOVE);
+        if (ptr == MAP_FAILED)
+            fail("mremap");
+
+        m_map    = ptr;
+        m_length = length;
+        m_data   = reinterpret_cast<T*>(static_cast<char*>(ptr) + data_offset);
+#else
+        munmap(m_map, m_length);
+        map(length);
+#endif
+    }
+
+    void close() noexcept
+    {
+        if (m_map)
+            munmap(m_map, m_length);
+        if (m_fd >= 0)
+            ::close(m_fd);
+
+        m_map  = nullptr;
+        m_data = nullptr;
+        m_fd   = -1;
+    }
+
+public:
+    // A moved-from vector owns no file and reads as empty: size(),
+    // capacity(), clear(), flush() and verify() are safe on it, and growing
+    // it throws because there is no file to extend. Assign a vector to it
+    // to use it again.
+
+    // Opens path, creating an empty vector there if the file is missing or
+    // empty. Throws if the file holds a different type.
+    explicit MappedVector(const std::string& path);
+    MappedVector(const MappedVector&)            = delete;
+    MappedVector& operator=(const MappedVector&) = delete;
+    MappedVector(MappedVector&& other) noexcept
+        : m_fd{ std::exchange(other.m_fd, -1) },
+          m_map{ std::exchange(other.m_map, nullptr) },
+          m_length{ std::exchange(other.m_length, 0) },
+          m_data{ std::exchange(other.m_data, nullptr) }
+    {}
+    MappedVector& operator=(MappedVector&& other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            m_fd     = std::exchange(other.m_fd, -1);
+            m_map    = std::exchange(other.m_map, nullptr);
+            m_length = std::exchange(other.m_length, 0);
+            m_data   = std::exchange(other.m_data, nullptr);
+        }
+        return *this;
+    }
+    ~MappedVector() { close(); }
+
+    void reserve(size_t capacity);
+    void push_back(const T& value);
+    void resize(size_t size);
+    void clear()
+    {
+        if (m_map)
+            header()->size = 0;
+    }
+    void flush();
+    // Recomputes the checksum over all elements; O(size).
+    bool verify() const;
+
+    size_t size() const { return m_map ? header()->size : 0; }
+    size_t capacity() const
+    {
+        return m_map ? (m_length - data_offset) / sizeof(T) : 0;
+    }
+    T*       data() { return m_data; }
+    const T* data() const { return m_data; }
+};
+
+template <typename T>
+MappedVector<T>::MappedVector(const std::string& path)
+{
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (m_fd < 0)
+        fail("open");
+
+    try
+    {
+        struct stat info;
+        if (fstat(m_fd, &info) != 0)
+            fail("fstat");
+
+        size_t length = static_cast<size_t>(info.st_size);
+        if (length == 0)
+        {
+            length = data_offset;
+            if (ftruncate(m_fd, static_cast<off_t>(length)) != 0)
+                fail("ftruncate");
+
+            map(length);
+            std::memcpy(header()->magic, magic, sizeof(magic));
+            header()->type_tag     = MappedTypeTag<T>::value();
+            header()->element_size = sizeof(T);
+            header()->size         = 0;
+            header()->checksum     = fnv1a(nullptr, 0);
+            return;
+        }
+
+        if (length < data_offset)
+            throw std::runtime_error{ "MappedVector: file too small" };
+
+        map(length);
+        if (std::memcmp(header()->magic, magic, sizeof(magic)) != 0)
+            throw std::runtime_error{ "MappedVector: bad magic" };
+        if (header()->type_tag != MappedTypeTag<T>::value() ||
+            header()->element_size != sizeof(T))
+            throw std::runtime_error{ "MappedVector: element type mismatch" };
+        if (header()->size > capacity())
+            throw std::runtime_error{ "MappedVector: truncated file" };
+    }
+    catch (...)
+    {
+        close();
+        throw;
+    }
+}
+
+template <typename T>
+void MappedVector<T>::reserve(size_t capacity)
+{
+    if (capacity <= this->capacity())
+        return;
+
+    size_t page   = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t length = data_offset + capacity * sizeof(T);
+    remap((length + page - 1) / page * page);
+}
+
+template <typename T>
+void MappedVector<T>::push_back(const T& value)
+{
+    size_t count = size();
+    if (count == capacity())
+        reserve(count == 0 ? 1 : count * 2);
+
+    std::memcpy(static_cast<void*>(m_data + count), &value, sizeof(T));
+    header()->size = count + 1;
+}
+
+template <typename T>
+void MappedVector<T>::resize(size_t size)
+{
+    size_t count = this->size();
+    if (size > count)
+    {
+        reserve(size);
+        std::memset(
+            static_cast<void*>(m_data + count), 0, (size - count) * sizeof(T)
+        );
+    }
+    if (size != count)
+        header()->size = size;
+}
+
+template <typename T>
+void MappedVector<T>::flush()
+{
+    if (!m_map)
+        return;
+
+    header()->checksum = fnv1a(m_data, size() * sizeof(T));
+    if (msync(m_map, m_length, MS_SYNC) != 0)
+        fail("msync");
+}
+
+template <typename T>
+bool MappedVector<T>::verify() const
+{
+    if (!m_map)
+        return true;
+
+    return header()->checksum == fnv1a(m_data, size() * sizeof(T));
+}
+
+int main()
+{
+    struct Entry
+    {
+        std::uint32_t key;
+        double        value;
+    };
+
+    auto path =
+        (std::filesystem::temp_directory_path() / "mappedvector_test.bin")
+            .string();
+    std::filesystem::remove(path);
+
+    // Build a table and flush it to disk
+    {
+        MappedVector<Entry> table{ path };
+        assert(table.size() == 0);
+        for (std::uint32_t i = 0; i < 10000; ++i)
+            table.push_back({ i, i * 0.25 });
+        assert(table.size() == 10000);
+        assert(table.capacity() >= 10000);
+        table.flush();
+        assert(table.verify());
+    }
+
+    // Reopen: the same elements are mapped back in place
+    {
+        MappedVector<Entry> table{ path };
+        assert(table.size() == 10000);
+        assert(table.verify());
+        assert(table.data()[1234].key == 1234);
+        assert(table.data()[9999].value == 9999 * 0.25);
+
+        // Unflushed edits are visible to readers but fail verification
+        table.data()[0].value = -1;
+        assert(!table.verify());
+
+        table.resize(20000);
+        assert(table.size() == 20000 && table.data()[19999].key == 0);
+        table.clear();
+        table.push_back({ 7, 7.0 });
+        table.flush();
+    }
+
+    // A moved-from vector reads as empty and refuses to grow
+    {
+        MappedVector<Entry> table{ path };
+        MappedVector<Entry> moved{ std::move(table) };
+        assert(moved.size() == 1 && moved.data()[0].key == 7);
+        assert(moved.verify());
+
+        assert(table.size() == 0 && table.capacity() == 0);
+        assert(table.verify());
+        table.clear();
+        table.flush();
+
+        bool threw = false;
+        try
+        {
+            table.push_back({ 8, 8.0 });
+        }
+        catch (const std::system_error&)
+        {
+            threw = true;
+        }
+        assert(threw);
+
+        table = std::move(moved);
+        assert(table.size() == 1 && moved.size() == 0);
+    }
+
+    // Opening as a different type is rejected
+    {
+        bool rejected = false;
+        try
+        {
+            MappedVector<int> wrong{ path };
+        }
+        catch (const std::runtime_error&)
+        {
+            rejected = true;
+        }
+        assert(rejected);
+    }
+
+    std::filesystem::remove(path);
+    std::cout << "All tests passed.\n";
+    return 0;
+}
@@ -1,25 +1,561 @@
+#ifndef MUTEX_CPP
+#define MUTEX_CPP
+
+#include <algorithm>
 #include <atomic>
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
 #include <thread>
 
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Blocks while word == expected, until woken. May return spuriously.
+inline void futex_wait(std::atomic<uint32_t>& word, uint32_t expected)
+{
+#ifdef __linux__
+    static_assert(sizeof(word) == sizeof(uint32_t));
+    syscall(
+        SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE,
+        expected, nullptr, nullptr, 0
+    );
+#else
+    word.wait(expected, std::memory_order_relaxed);
+#endif
+}
+
+// Like futex_wait, but gives up once timeout has passed. Off Linux,
+// std::atomic::wait has no timeout, so this sleeps briefly and returns.
+inline void futex_wait_for(
+    std::atomic<uint32_t>& word, uint32_t expected,
+    std::chrono::nanoseconds timeout
+)
+{
+    if (timeout <= std::chrono::nanoseconds::zero())
+        return;
+#ifdef __linux__
+    timespec relative{
+        static_cast<time_t>(timeout.count() / 1'000'000'000),
+        static_cast<long>(timeout.count() % 1'000'000'000)
+    };
+    syscall(
+        SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE,
+        expected, &relative, nullptr, 0
+    );
+#else
+    if (word.load(std::memory_order_relaxed) == expected)
+        std::this_thread::sleep_for(
+            std::min<std::chrono::nanoseconds>(
+                timeout, std::chrono::microseconds(50)
+            )
+        );
+#endif
+}
+
+// Wakes one thread blocked in futex_wait on word.
+inline void futex_wake_one(std::atomic<uint32_t>& word)
+{
+#ifdef __linux__
+    syscall(
+        SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, 1,
+        nullptr, nullptr, 0
+    );
+#else
+    word.notify_one();
+#endif
+}
+
+// Wakes every thread blocked in futex_wait on word.
+inline void futex_wake_all(std::atomic<uint32_t>& word)
+{
+#ifdef __linux__
+    syscall(
+        SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE,
+        INT32_MAX, nullptr, nullptr, 0
+    );
+#else
+    word.notify_all();
+#endif
+}
+
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Spin-then-park mutex. The state is unlocked, locked (no waiters) or
+// contended (someone may be parked). An uncontended lock/unlock is a
+// single atomic each and never enters the kernel. A contended lock spins
+// for a short while with exponential backoff, reading rather than writing
+// the shared line, then marks the mutex contended and parks on a futex;
+// unlock only issues a wake when the state says someone may be waiting.
 class Mutex
 {
 public:
-    Mutex()
-        : m_flag(ATOMIC_FLAG_INIT)
+    Mutex() = default;
+    Mutex(const Mutex&)            = delete;
+    Mutex& operator=(const Mutex&) = delete;
+
+    void lock()
+    {
+        uint32_t state = unlocked;
+        if (!m_state.compare_exchange_strong(
+                state, locked, std::memory_order_acquire,
+                std::memory_order_relaxed
+            ))
+            lock_contended();
+    }
+
+    void unlock()
+    {
+        if (m_state.exchange(unlocked, std::memory_order_release) == contended)
+            futex_wake_one(m_state);
+    }
+
+    bool try_lock()
+    {
+        uint32_t state = unlocked;
+        return m_state.compare_exchange_strong(
+            state, locked, std::memory_order_acquire, std::memory_order_relaxed
+        );
+    }
+
+private:
+    static constexpr uint32_t unlocked  = 0;
+    static constexpr uint32_t locked    = 1;
+    static constexpr uint32_t contended = 2;
+
+    static constexpr int      spin_rounds = 10;
+    static constexpr unsigned max_backoff = 64;   // pause instructions
+
+    std::atomic<uint32_t> m_state{ unlocked };
+
+    void lock_contended()
+    {
+        unsigned backoff = 1;
+        for (int round = 0; round < spin_rounds; ++round)
+        {
+            for (unsigned i = 0; i < backoff; ++i)
+                cpu_relax();
+            backoff = std::min(backoff * 2, max_backoff);
+
+            uint32_t state = m_state.load(std::memory_order_relaxed);
+            if (state == contended)
+                break;   // Others are parked already; queue up behind them
+            if (state == unlocked &&
+                m_state.compare_exchange_weak(
+                    state, locked, std::memory_order_acquire,
+                    std::memory_order_relaxed
+                ))
+                return;
+        }
+
+        // Taking the lock this way leaves it marked contended, which may
+        // cost one spare wake on unlock but never loses one.
+        while (m_state.exchange(contended, std::memory_order_acquire) !=
+               unlocked)
+            futex_wait(m_state, contended);
+    }
+};
+
+// FIFO spin lock: each locker takes a ticket and waits until it is
+// served, so no thread can be overtaken. Waiters back off in proportion
+// to their distance from the head of the queue, and yield once they have
+// spun for a while so an oversubscribed machine still makes progress.
+// All waiters watch the same serving counter; prefer McsLock when many
+// threads contend.
+class TicketLock
+{
+public:
+    TicketLock() = default;
+    TicketLock(const TicketLock&)            = delete;
+    TicketLock& operator=(const TicketLock&) = delete;
+
+    void lock()
+    {
+        uint32_t ticket = m_next.fetch_add(1, std::memory_order_relaxed);
+        for (int round = 0;; ++round)
+        {
+            uint32_t serving = m_serving.load(std::memory_order_acquire);
+            if (serving == ticket)
+                return;
+
+            if (round < spin_rounds)
+            {
+                for (uint32_t i = 0; i < (ticket - serving) * backoff_unit; ++i)
+                    cpu_relax();
+            }
+            else
+                std::this_thread::yield();
+        }
+    }
+
+    void unlock()
+    {
+        m_serving.store(
+            m_serving.load(std::memory_order_relaxed) + 1,
+            std::memory_order_release
+        );
+    }
+
+    // Takes the lock only if nobody holds or waits for it.
+    bool try_lock()
+    {
+        uint32_t serving = m_serving.load(std::memory_order_acquire);
+        uint32_t next    = serving;
+        return m_next.compare_exchange_strong(
+            next, serving + 1, std::memory_order_acquire,
+            std::memory_order_relaxed
+        );
+    }
+
+private:
+    static constexpr int      spin_rounds  = 100;
+    static constexpr uint32_t backoff_unit = 16;   // pause per waiter ahead
+
+    alignas(64) std::atomic<uint32_t> m_next{ 0 };
+    alignas(64) std::atomic<uint32_t> m_serving{ 0 };
+};
+
+// MCS queue lock: waiters form a linked queue and each spins on a flag in
+// its own cache-line-sized node, so a handoff touches only the next
+// waiter's line and ownership passes in FIFO order. A waiter that spins
+// for too long parks on its node's flag, and is woken individually.
+//
+// Nodes come from a small per-thread pool, which keeps the plain
+// lock/unlock/try_lock interface (and std::lock_guard) working; a thread
+// holding more than max_held MCS locks at once gets heap nodes for the
+// rest. A lock must be unlocked on the thread that locked it.
+class McsLock
+{
+public:
+    static constexpr int max_held = 16;
+
+    McsLock() = default;
+    McsLock(const McsLock&)            = delete;
+    McsLock& operator=(const McsLock&) = delete;
+
+    void lock()
+    {
+        Node* node = NodePool::local().take();
+        Node* prev = m_tail.exchange(node, std::memory_order_acq_rel);
+        if (prev)
+        {
+            prev->next.store(node, std::memory_order_release);
+            wait_for_grant(*node);
+        }
+        m_holder = node;
+    }
+
+    void unlock()
+    {
+        Node* node = m_holder;
+        Node* next = node->next.load(std::memory_order_acquire);
+        if (!next)
+        {
+            Node* expected = node;
+            if (m_tail.compare_exchange_strong(
+                    expected, nullptr, std::memory_order_release,
+                    std::memory_order_relaxed
+                ))
+            {
+                NodePool::local().give(node);
+                return;
+            }
+
+            // A successor swapped itself in and is about to link up.
+            while (!(next = node->next.load(std::memory_order_acquire)))
+                cpu_relax();
+        }
+
+        if (next->state.exchange(granted, std::memory_order_release) == parked)
+            futex_wake_one(next->state);
+        NodePool::local().give(node);
+    }
+
+    bool try_lock()
+    {
+        Node* node     = NodePool::local().take();
+        Node* expected = nullptr;
+        if (m_tail.compare_exchange_strong(
+                expected, node, std::memory_order_acquire,
+                std::memory_order_relaxed
+            ))
+        {
+            m_holder = node;
+            return true;
+        }
+
+        NodePool::local().give(node);
+        return false;
+    }
+
+private:
+    static constexpr uint32_t waiting = 0;
+    static constexpr uint32_t parked  = 1;
+    static constexpr uint32_t granted = 2;
+
+    static constexpr int spin_rounds = 1000;
+
+    struct alignas(64) Node
+    {
+        std::atomic<Node*>    next{ nullptr };
+        std::atomic<uint32_t> state{ waiting };
+    };
+
+    class NodePool
+    {
+    private:
+        Node     m_nodes[max_held];
+        uint32_t m_used{ 0 };
+
+    public:
+        static NodePool& local()
+        {
+            thread_local NodePool pool;
+            return pool;
+        }
+
+        Node* take()
+        {
+            int index = std::countr_one(m_used);
+            if (index >= max_held)
+                return new Node;
+
+            m_used |= 1u << index;
+            Node& node = m_nodes[index];
+            node.next.store(nullptr, std::memory_order_relaxed);
+            node.state.store(waiting, std::memory_order_relaxed);
+            return &node;
+        }
+
+        void give(Node* node)
+        {
+            std::less<const Node*> before;
+            if (before(node, m_nodes) || !before(node, m_nodes + max_held))
+                delete node;
+            else
+                m_used &= ~(1u << (node - m_nodes));
+        }
+    };
+
+    alignas(64) std::atomic<Node*> m_tail{ nullptr };
+    // Written and read only by the thread holding the lock.
+    Node* m_holder{ nullptr };
+
+    static void wait_for_grant(Node& node)
+    {
+        for (int round = 0; round < spin_rounds; ++round)
+        {
+            if (node.state.load(std::memory_order_acquire) == granted)
+                return;
+            cpu_relax();
+        }
+
+        uint32_t state = waiting;
+        if (!node.state.compare_exchange_strong(
+                state, parked, std::memory_order_acquire,
+                std::memory_order_acquire
+            ))
+            return;   // Granted meanwhile
+
+        while (node.state.load(std::memory_order_acquire) != granted)
+            futex_wait(node.state, parked);
+    }
+};
+
+// Reader-writer lock for read-mostly data. Each reader only touches the
+// counter in its own cache-line-padded slot (threads are spread over the
+// slots round-robin), so concurrent readers never share a written line.
+// A writer serializes with other writers on a Mutex, raises the writer
+// flag and then waits for every slot to drain; readers that see the flag
+// back out and park until the writer is done.
+//
+// With preferWriters (the default) the flag goes up first, so a steady
+// stream of readers cannot starve a writer. Otherwise the writer only
+// marks itself draining, which readers ignore, waits for a moment with no
+// readers before raising the flag, and steps back if one slips in, so
+// readers are never held up by a waiting writer.
+//
+// unlock_shared must be called on the thread that called lock_shared.
+class SharedMutex
+{
+public:
+    static constexpr size_t reader_slots = 64;
+
+    explicit SharedMutex(bool preferWriters = true)
+        : m_preferWriters{ preferWriters }
     {}
+    SharedMutex(const SharedMutex&)            = delete;
+    SharedMutex& operator=(const SharedMutex&) = delete;
+
+    void lock_shared()
+    {
+        Slot& slot = reader_slot();
+        while (true)
+        {
+            slot.readers.fetch_add(1, std::memory_order_seq_cst);
+            if (!(m_writer.load(std::memory_order_seq_cst) & writing))
+                return;
+
+            leave(slot);
+            wait_for_writer();
+        }
+    }
+
+    bool try_lock_shared()
+    {
+        Slot& slot = reader_slot();
+        slot.readers.fetch_add(1, std::memory_order_seq_cst);
+        if (!(m_writer.load(std::memory_order_seq_cst) & writing))
+            return true;
+
+        leave(slot);
+        return false;
+    }
+
+    void unlock_shared() { leave(reader_slot()); }
 
     void lock()
     {
-        while (m_flag.test_and_set(std::memory_order_acquire))
+        m_writers.lock();
+        if (m_preferWriters)
+        {
+            m_writer.store(writing, std::memory_order_seq_cst);
+            drain();
+            return;
+        }
+
+        while (true)
         {
-            std::this_thread::yield();
+            m_writer.store(draining, std::memory_order_seq_cst);
+            drain();
+            m_writer.store(writing, std::memory_order_seq_cst);
+            if (drained())
+                return;
+            release_readers();
         }
     }
 
-    void unlock() { m_flag.clear(std::memory_order_release); }
+    bool try_lock()
+    {
+        if (!m_writers.try_lock())
+            return false;
+
+        m_writer.store(writing, std::memory_order_seq_cst);
+        if (drained())
+            return true;
 
-    bool try_lock() { return !m_flag.test_and_set(std::memory_order_acquire); }
+        release_readers();
+        m_writers.unlock();
+        return false;
+    }
+
+    void unlock()
+    {
+        release_readers();
+        m_writers.unlock();
+    }
 
 private:
-    std::atomic_flag m_flag;
+    static constexpr uint32_t writing        = 1;
+    static constexpr uint32_t readers_parked = 2;
+    static constexpr uint32_t draining       = 4;   // Readers may still enter
+
+    static constexpr int spin_rounds = 100;
+
+    struct alignas(64) Slot
+    {
+        std::atomic<uint32_t> readers{ 0 };
+    };
+
+    Slot                              m_slots[reader_slots];
+    alignas(64) std::atomic<uint32_t> m_writer{ 0 };
+    Mutex                             m_writers;
+    bool                              m_preferWriters;
+
+    static size_t slot_index()
+    {
+        static std::atomic<size_t> next{ 0 };
+        thread_local size_t        index =
+            next.fetch_add(1, std::memory_order_relaxed) % reader_slots;
+        return index;
+    }
+
+    Slot& reader_slot() { return m_slots[slot_index()]; }
+
+    // The last reader out of a slot wakes a writer draining it; any set
+    // bit means a writer may be parked on the slots.
+    void leave(Slot& slot)
+    {
+        if (slot.readers.fetch_sub(1, std::memory_order_seq_cst) == 1 &&
+            m_writer.load(std::memory_order_seq_cst) != 0)
+            futex_wake_all(slot.readers);
+    }
+
+    void wait_for_writer()
+    {
+        for (int round = 0; round < spin_rounds; ++round)
+        {
+            if (!(m_writer.load(std::memory_order_relaxed) & writing))
+                return;
+            cpu_relax();
+        }
+
+        uint32_t writer = m_writer.load(std::memory_order_relaxed);
+        while (writer & writing)
+        {
+            if (!(writer & readers_parked) &&
+                !m_writer.compare_exchange_weak(
+                    writer, writer | readers_parked, std::memory_order_relaxed
+                ))
+                continue;
+
+            futex_wait(m_writer, writer | readers_parked);
+            writer = m_writer.load(std::memory_order_relaxed);
+        }
+    }
+
+    void release_readers()
+    {
+        if (m_writer.exchange(0, std::memory_order_release) & readers_parked)
+            futex_wake_all(m_writer);
+    }
+
+    bool drained() const
+    {
+        for (const Slot& slot : m_slots)
+        {
+            if (slot.readers.load(std::memory_order_seq_cst) != 0)
+                return false;
+        }
+        return true;
+    }
+
+    // seq_cst, like drained(): the writer's store to m_writer and these
+    // loads must not be reordered against a reader's increment and its
+    // load of m_writer, or both could get in.
+    void drain()
+    {
+        for (Slot& slot : m_slots)
+        {
+            uint32_t readers;
+            while ((readers = slot.readers.load(std::memory_order_seq_cst)))
+                futex_wait(slot.readers, readers);
+        }
+    }
 };
+
+#endif   // MUTEX_CPP
@@ -0,0 +1,433 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Long-lived worker threads fed from a single task queue. Unlike
+// ProducerConsumer, the threads are started once and reused by every
+// parallel algorithm call.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(size_t workers)
+    {
+        for (size_t i{ 0 }; i < workers; ++i)
+            m_workers.emplace_back([this] { run(); });
+    }
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard lock{ m_mutex };
+            m_done = true;
+        }
+        m_condition.notify_all();
+        for (auto& worker : m_workers)
+            worker.join();
+    }
+
+    void submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard lock{ m_mutex };
+            m_tasks.push(std::move(task));
+        }
+        m_condition.notify_one();
+    }
+
+    size_t size() const { return m_workers.size(); }
+
+    // Shared pool with one worker per core besides the calling thread,
+    // which always takes part in the work it submits.
+    static ThreadPool& instance()
+    {
+        static ThreadPool pool{ std::max(
+            std::thread::hardware_concurrency(), 1u
+        ) - 1 };
+        return pool;
+    }
+
+private:
+    void run()
+    {
+        while (true)
+        {
+            std::unique_lock lock{ m_mutex };
+            m_condition.wait(
+                lock, [this] { return !m_tasks.empty() || m_done; }
+            );
+            if (m_tasks.empty())
+                break;
+
+            auto task = std::move(m_tasks.front());
+            m_tasks.pop();
+            lock.unlock();
+            task();
+        }
+    }
+
+    mutable std::mutex                m_mutex{};
+    std::queue<std::function<void()>> m_tasks{};
+    std::condition_variable           m_condition{};
+    std::vector<std::thread>          m_workers{};
+    bool                              m_done{ false };
+};
+
+struct ParallelOptions
+{
+    size_t      grain{ 16384 };           // Elements per chunk
+    size_t      serial_cutoff{ 32768 };   // Inputs this small run inline
+    ThreadPool* pool{ nullptr };          // Defaults to ThreadPool::instance()
+};
+
+// Splits [0, n) into grain-sized chunks and calls body(begin, end, chunk)
+// for each. Chunks are claimed from a shared counter by the caller and by
+// up to pool.size() helper tasks; the caller only waits for the chunks, not
+// for the helpers, so nested calls from inside a worker cannot deadlock.
+// The first exception thrown by body is rethrown to the caller.
+template <class Body>
+void parallel_chunks(size_t n, const ParallelOptions& options, Body&& body)
+{
+    ThreadPool& pool = options.pool ? *options.pool : ThreadPool::instance();
+    size_t      grain  = std::max<size_t>(options.grain, 1);
+    size_t      chunks = (n + grain - 1) / grain;
+
+    if (n <= options.serial_cutoff || pool.size() == 0 || chunks < 2)
+    {
+        for (size_t chunk{ 0 }; chunk < chunks; ++chunk)
+            body(chunk * grain, std::min(n, (chunk + 1) * grain), chunk);
+        return;
+    }
+
+    struct Job
+    {
+        std::atomic<size_t> next{ 0 };
+        std::atomic<size_t> done{ 0 };
+        std::mutex          mutex{};
+        std::exception_ptr  error{};
+    };
+
+    // Helpers may start after the call returned; they only touch body
+    // after successfully claiming a chunk, which by then is impossible.
+    auto job  = std::make_shared<Job>();
+    auto work = [job, n, grain, chunks, &body]
+    {
+        size_t chunk;
+        while ((chunk = job->next.fetch_add(1, std::memory_order_relaxed)) <
+               chunks)
+        {
+            try
+            {
+                body(chunk * grain, std::min(n, (chunk + 1) * grain), chunk);
+            }
+            catch (...)
+            {
+                std::lock_guard lock{ job->mutex };
+                if (!job->error)
+                    job->error = std::current_exception();
+            }
+
+            if (job->done.fetch_add(1, std::memory_order_acq_rel) + 1 == chunks)
+                job->done.notify_all();
+        }
+    };
+
+    size_t helpers = std::min(pool.size(), chunks - 1);
+    for (size_t i{ 0 }; i < helpers; ++i)
+        pool.submit(work);
+    work();
+
+    size_t finished = job->done.load(std::memory_order_acquire);
+    while (finished != chunks)
+    {
+        job->done.wait(finished, std::memory_order_acquire);
+        finished = job->done.load(std::memory_order_acquire);
+    }
+
+    if (job->error)
+        std::rethrow_exception(job->error);
+}
+
+// Calls f(first[i]) for every element.
+template <class T, class F>
+void parallel_for(T* first, size_t n, F f, const ParallelOptions& options = {})
+{
+    parallel_chunks(
+        n, options,
+        [&](size_t begin, size_t end, size_t)
+        {
+            for (size_t i{ begin }; i < end; ++i)
+                f(first[i]);
+        }
+    );
+}
+
+// Folds every chunk with op starting from init, then folds the chunk
+// results in order; op must be associative and init its identity.
+template <class T, class R, class Op>
+R parallel_reduce(
+    const T* first, size_t n, R init, Op op, const ParallelOptions& options = {}
+)
+{
+    size_t         grain = std::max<size_t>(options.grain, 1);
+    std::vector<R> partial((n + grain - 1) / grain, init);
+
+    parallel_chunks(
+        n, options,
+        [&](size_t begin, size_t end, size_t chunk)
+        {
+            R value = init;
+            for (size_t i{ begin }; i < end; ++i)
+                value = op(std::move(value), first[i]);
+            partial[chunk] = std::move(value);
+        }
+    );
+
+    R result = init;
+    for (auto& value : partial)
+        result = op(std::move(result), std::move(value));
+    return result;
+}
+
+// out[i] = f(in[i]); in and out may be the same range.
+template <class T, class U, class F>
+void parallel_transform(
+    const T* in, size_t n, U* out, F f, const ParallelOptions& options = {}
+)
+{
+    parallel_chunks(
+        n, options,
+        [&](size_t begin, size_t end, size_t)
+        {
+            for (size_t i{ begin }; i < end; ++i)
+                out[i] = f(in[i]);
+        }
+    );
+}
+
+// Parallel merge sort: runs are sorted independently, then merged pairwise
+// in parallel rounds, ping-ponging between the input and a scratch buffer.
+template <class T, class Compare = std::less<>>
+void parallel_sort(
+    T* first, size_t n, Compare comp = {}, const ParallelOptions& options = {}
+)
+{
+    ThreadPool& pool = options.pool ? *options.pool : ThreadPool::instance();
+    if (n <= options.serial_cutoff || pool.size() == 0)
+    {
+        std::sort(first, first + n, comp);
+        return;
+    }
+
+    // Aim for a few runs per thread so the merge rounds stay balanced.
+    size_t runs = 4 * (pool.size() + 1);
+    size_t run  = std::max(options.grain, (n + runs - 1) / runs);
+
+    ParallelOptions runOptions = options;
+    runOptions.grain           = 1;
+    runOptions.serial_cutoff   = 0;
+
+    parallel_chunks(
+        (n + run - 1) / run, runOptions,
+        [&](size_t begin, size_t end, size_t)
+        {
+            for (size_t r{ begin }; r < end; ++r)
+                std::sort(
+                    first + r * run, first + std::min(n, (r + 1) * run), comp
+                );
+        }
+    );
+
+    // The sorted runs move into the buffer, so the first round merges back
+    // into the (moved-from) input.
+    std::vector<T> buffer(
+        std::make_move_iterator(first), std::make_move_iterator(first + n)
+    );
+    T* source = buffer.data();
+    T* target = first;
+
+    for (size_t width{ run }; width < n; width *= 2)
+    {
+        size_t pairs = (n + 2 * width - 1) / (2 * width);
+        parallel_chunks(
+            pairs, runOptions,
+            [&](size_t begin, size_t end, size_t)
+            {
+                for (size_t p{ begin }; p < end; ++p)
+                {
+                    size_t lo  = p * 2 * width;
+                    size_t mid = std::min(n, lo + width);
+                    size_t hi  = std::min(n, lo + 2 * width);
+                    std::merge(
+                        std::make_move_iterator(source + lo),
+                        std::make_move_iterator(source + mid),
+                        std::make_move_iterator(source + mid),
+                        std::make_move_iterator(source + hi), target + lo, comp
+                    );
+                }
+            }
+        );
+        std::swap(source, target);
+    }
+
+    if (source != first)
+        std::move(source, source + n, first);
+}
+
+// Container overloads for anything exposing data() and size(), such as
+// array and Vector.
+template <class Container, class F>
+void parallel_for(Container& c, F f, const ParallelOptions& options = {})
+{
+    parallel_for(c.data(), c.size(), std::move(f), options);
+}
+
+template <class Container, class R, class Op>
+R parallel_reduce(
+    const Container& c, R init, Op op, const ParallelOptions& options = {}
+)
+{
+    return parallel_reduce(
+        c.data(), c.size(), std::move(init), std::move(op), options
+    );
+}
+
+template <class In, class Out, class F>
+void parallel_transform(
+    const In& in, Out& out, F f, const ParallelOptions& options = {}
+)
+{
+    assert(out.size() >= in.size());
+    parallel_transform(in.data(), in.size(), out.data(), std::move(f), options);
+}
+
+template <class Container, class Compare = std::less<>>
+void parallel_sort(
+    Container& c, Compare comp = {}, const ParallelOptions& options = {}
+)
+{
+    parallel_sort(c.data(), c.size(), std::move(comp), options);
+}
+
+int main()
+{
+    ThreadPool      pool{ 4 };
+    ParallelOptions options;
+    options.pool          = &pool;
+    options.grain         = 1000;
+    options.serial_cutoff = 2000;
+
+    // parallel_for touches every element exactly once
+    {
+        std::vector<long> v(1000000, 1);
+        parallel_for(v, [](long& x) { x *= 3; }, options);
+        assert(std::all_of(v.begin(), v.end(), [](long x) { return x == 3; }));
+    }
+
+    // parallel_reduce matches the serial fold
+    {
+        std::vector<long> v(1000003);
+        std::iota(v.begin(), v.end(), 0);
+        long sum = parallel_reduce(v, 0L, std::plus<>{}, options);
+        assert(sum == 1000002L * 1000003L / 2);
+
+        long small = parallel_reduce(v.data(), 10, 0L, std::plus<>{}, options);
+        assert(small == 45);
+    }
+
+    // parallel_transform writes into a separate output
+    {
+        std::vector<int>    in(500000, 2);
+        std::vector<double> out(in.size());
+        parallel_transform(in, out, [](int x) { return x * 1.5; }, options);
+        assert(out.front() == 3.0 && out.back() == 3.0);
+    }
+
+    // parallel_sort agrees with std::sort
+    {
+        std::mt19937     rng{ 42 };
+        std::vector<int> v(1234567);
+        for (auto& x : v)
+            x = static_cast<int>(rng());
+        auto expected = v;
+        std::sort(expected.begin(), expected.end());
+
+        parallel_sort(v, std::less<>{}, options);
+        assert(v == expected);
+
+        parallel_sort(v, std::greater<>{}, options);
+        assert(std::is_sorted(v.begin(), v.end(), std::greater<>{}));
+    }
+
+    // parallel_sort keeps the values of non-trivial types
+    {
+        std::mt19937             rng{ 7 };
+        std::vector<std::string> v(10000);
+        for (auto& s : v)
+            s = std::to_string(rng()) + " padding past the SSO buffer";
+        auto expected = v;
+        std::sort(expected.begin(), expected.end());
+
+        parallel_sort(v, std::less<>{}, options);
+        assert(v == expected);
+    }
+
+    // Exceptions from the body reach the caller
+    {
+        std::vector<int> v(100000);
+        bool             caught = false;
+        try
+        {
+            parallel_for(
+                v.data(), v.size(),
+                [](int& x)
+                {
+                    if (x == 0)
+                        throw std::runtime_error{ "boom" };
+                },
+                options
+            );
+        }
+        catch (const std::runtime_error&)
+        {
+            caught = true;
+        }
+        assert(caught);
+    }
+
+    // Nested calls from inside a worker complete
+    {
+        std::vector<int> outer(8, 0);
+        parallel_chunks(
+            outer.size(), { 1, 0, &pool },
+            [&](size_t begin, size_t, size_t)
+            {
+                std::vector<int> inner(10000, 1);
+                outer[begin] =
+                    parallel_reduce(inner, 0, std::plus<>{}, options);
+            }
+        );
+        for (int x : outer)
+            assert(x == 10000);
+    }
+
+    std::cout << "All tests passed.\n";
+    return 0;
+}
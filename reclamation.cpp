@@ -0,0 +1,651 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Deferred deletion for lock-free structures. A reader pins a domain for
+// the length of an operation and reads shared pointers through the Guard;
+// a writer that unlinks a node retires it through its Guard, and the node
+// is deleted once no guard can still be reading it.
+//
+// EpochDomain and HazardDomain hand out the same Guard interface, so a
+// structure can take the domain as a template parameter. Epochs make
+// reads almost free but let a stalled reader hold back all reclamation;
+// hazard pointers cost a fence per protected read but bound the garbage
+// no matter what readers do.
+namespace reclaim
+{
+
+// An object waiting for reclamation together with its deleter, which
+// follows UniquePointer's convention: any callable taking T*. Empty
+// deleters are rebuilt at reclamation time; others are kept on the heap
+// until then.
+struct Retired
+{
+    void*         ptr;
+    void*         deleter;
+    void          (*destroy)(void* ptr, void* deleter);
+    std::uint64_t epoch;
+
+    // Appends ptr to list. The heap copy of a stateful deleter stays in a
+    // unique_ptr until the entry is in the list, so if the push throws
+    // nothing leaks and ptr is left to the caller.
+    template <class T, class Deleter>
+    static void push(
+        std::vector<Retired>& list, T* ptr, Deleter deleter,
+        std::uint64_t epoch
+    )
+    {
+        if constexpr (std::is_empty_v<Deleter> &&
+                      std::is_default_constructible_v<Deleter>)
+        {
+            list.push_back(
+                { ptr, nullptr,
+                  [](void* p, void*) { Deleter{}(static_cast<T*>(p)); },
+                  epoch }
+            );
+        }
+        else
+        {
+            auto held = std::make_unique<Deleter>(std::move(deleter));
+            list.push_back(
+                { ptr, held.get(),
+                  [](void* p, void* d)
+                  {
+                      std::unique_ptr<Deleter> owned{
+                          static_cast<Deleter*>(d)
+                      };
+                      (*owned)(static_cast<T*>(p));
+                  },
+                  epoch }
+            );
+            held.release();
+        }
+    }
+
+    void reclaim() const { destroy(ptr, deleter); }
+};
+
+// Fixed table of per-thread records, each claimed for the lifetime of a
+// Guard. Threads start probing at a slot picked from their id, so in the
+// steady state each one keeps landing on the same uncontended line.
+//
+// A slot keeps its retired list after its guard goes, and the thread that
+// held it may never come back; adopt_orphans hands such lists over to a
+// guard that is about to collect.
+template <class Slot>
+class SlotTable
+{
+private:
+    static constexpr int claim_passes = 3;
+
+    size_t                  m_count;
+    std::unique_ptr<Slot[]> m_slots;
+
+public:
+    explicit SlotTable(size_t count)
+        : m_count{ count }, m_slots{ std::make_unique<Slot[]>(count) }
+    {
+        assert(count > 0);
+    }
+
+    // Throws once every slot stays taken for a few passes: waiting longer
+    // would deadlock a thread that nests more guards than there are slots.
+    Slot* claim()
+    {
+        size_t start = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        for (int pass{ 0 }; pass < claim_passes; ++pass)
+        {
+            for (size_t i{ 0 }; i < m_count; ++i)
+            {
+                if (Slot* slot = try_claim(m_slots[(start + i) % m_count]))
+                    return slot;
+            }
+            std::this_thread::yield();
+        }
+        throw std::length_error{ "reclaim: every slot is held by a guard" };
+    }
+
+    // Moves the retired lists of slots no guard holds onto into's list.
+    // Each idle slot is claimed only while its list is moved.
+    void adopt_orphans(Slot& into)
+    {
+        for (size_t i{ 0 }; i < m_count; ++i)
+        {
+            Slot* idle = try_claim(m_slots[i]);
+            if (!idle)
+                continue;
+
+            into.retired.insert(
+                into.retired.end(), idle->retired.begin(), idle->retired.end()
+            );
+            idle->retired.clear();
+            unclaim(idle);
+        }
+    }
+
+    void unclaim(Slot* slot) noexcept
+    {
+        slot->in_use.store(false, std::memory_order_release);
+    }
+
+    size_t size() const { return m_count; }
+    Slot&  operator[](size_t index) { return m_slots[index]; }
+
+private:
+    static Slot* try_claim(Slot& slot) noexcept
+    {
+        if (slot.in_use.load(std::memory_order_relaxed) ||
+            slot.in_use.exchange(true, std::memory_order_acquire))
+            return nullptr;
+        return &slot;
+    }
+};
+
+// Keeps the pointers read through it safe until destroyed. Obtained from
+// a domain's pin().
+template <class Domain>
+class Guard
+{
+private:
+    Domain*                m_domain;
+    typename Domain::Slot* m_slot;
+
+public:
+    explicit Guard(Domain& domain)
+        : m_domain{ &domain }, m_slot{ &domain.enter() }
+    {}
+    Guard(const Guard&)            = delete;
+    Guard& operator=(const Guard&) = delete;
+    ~Guard() { m_domain->leave(*m_slot); }
+
+    // Loads source; the object it points to stays alive while this guard
+    // does. index picks one of the slot's hazard pointers and is ignored
+    // by epochs; protecting again with the same index drops the old one.
+    template <class T>
+    T* protect(const std::atomic<T*>& source, size_t index = 0)
+    {
+        return m_domain->protect(*m_slot, source, index);
+    }
+
+    // Deletes ptr once no guard can still be reading it. It must already
+    // be unreachable for guards pinned from now on. If this throws, ptr
+    // was not retired and is still the caller's.
+    template <class T, class Deleter = std::default_delete<T>>
+    void retire(T* ptr, Deleter deleter = Deleter{})
+    {
+        m_domain->retire(*m_slot, ptr, std::move(deleter));
+    }
+};
+
+// Epoch-based reclamation. Pinning announces the global epoch in the
+// thread's slot; the epoch advances once every pinned slot has seen the
+// current one, and objects retired in epoch e are deleted from e + 2 on.
+//
+// Each slot collects every collect_threshold retirements, so garbage per
+// slot stays near that threshold as long as no guard is held for long;
+// a guard that never unpins stops the epoch and with it all reclamation.
+class EpochDomain
+{
+public:
+    using Guard = reclaim::Guard<EpochDomain>;
+
+    static constexpr size_t collect_threshold = 64;
+
+    explicit EpochDomain(size_t slots = 128)
+        : m_slots{ slots }
+    {}
+    EpochDomain(const EpochDomain&)            = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+    // Every guard must be gone; whatever is still retired is deleted.
+    ~EpochDomain();
+
+    Guard pin() { return Guard{ *this }; }
+
+    // Retired objects not yet deleted.
+    size_t pending() const { return m_pending.load(std::memory_order_relaxed); }
+
+private:
+    friend class reclaim::Guard<EpochDomain>;
+
+    struct alignas(64) Slot
+    {
+        std::atomic<bool>          in_use{ false };
+        // (epoch << 1) | 1 while pinned, 0 otherwise.
+        std::atomic<std::uint64_t> epoch{ 0 };
+        std::vector<Retired>       retired{};
+    };
+
+    SlotTable<Slot>                        m_slots;
+    alignas(64) std::atomic<std::uint64_t> m_epoch{ 1 };
+    alignas(64) std::atomic<size_t>        m_pending{ 0 };
+
+    Slot& enter()
+    {
+        Slot& slot  = *m_slots.claim();
+        auto  epoch = m_epoch.load(std::memory_order_relaxed);
+        slot.epoch.store((epoch << 1) | 1, std::memory_order_relaxed);
+        // Orders the announcement before every read made under the guard.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return slot;
+    }
+
+    void leave(Slot& slot) noexcept
+    {
+        slot.epoch.store(0, std::memory_order_release);
+        m_slots.unclaim(&slot);
+    }
+
+    template <class T>
+    T* protect(Slot&, const std::atomic<T*>& source, size_t)
+    {
+        return source.load(std::memory_order_acquire);
+    }
+
+    template <class T, class Deleter>
+    void retire(Slot& slot, T* ptr, Deleter deleter)
+    {
+        Retired::push(
+            slot.retired, ptr, std::move(deleter),
+            m_epoch.load(std::memory_order_seq_cst)
+        );
+        m_pending.fetch_add(1, std::memory_order_relaxed);
+
+        if (slot.retired.size() % collect_threshold == 0)
+        {
+            try_advance();
+            m_slots.adopt_orphans(slot);
+            collect(slot);
+        }
+    }
+
+    void try_advance() noexcept
+    {
+        auto epoch = m_epoch.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (size_t i{ 0 }; i < m_slots.size(); ++i)
+        {
+            auto announced = m_slots[i].epoch.load(std::memory_order_acquire);
+            if ((announced & 1) && (announced >> 1) != epoch)
+                return;
+        }
+        m_epoch.compare_exchange_strong(epoch, epoch + 1);
+    }
+
+    void collect(Slot& slot) noexcept
+    {
+        auto   epoch = m_epoch.load(std::memory_order_acquire);
+        size_t kept  = 0;
+        for (const Retired& retired : slot.retired)
+        {
+            if (retired.epoch + 2 <= epoch)
+                retired.reclaim();
+            else
+                slot.retired[kept++] = retired;
+        }
+
+        m_pending.fetch_sub(
+            slot.retired.size() - kept, std::memory_order_relaxed
+        );
+        slot.retired.resize(kept);
+    }
+};
+
+inline EpochDomain::~EpochDomain()
+{
+    for (size_t i{ 0 }; i < m_slots.size(); ++i)
+    {
+        assert(!m_slots[i].in_use.load());
+        for (const Retired& retired : m_slots[i].retired)
+            retired.reclaim();
+    }
+}
+
+// Hazard-pointer reclamation. Each slot publishes up to hazards_per_slot
+// pointers its guard is reading; a retired object is deleted once no slot
+// publishes it. A slot scans all hazards when its list reaches
+// scan_threshold() and keeps at most the hazarded objects, so a domain
+// never holds more than max_pending() retired objects, stalled readers
+// or not.
+class HazardDomain
+{
+public:
+    using Guard = reclaim::Guard<HazardDomain>;
+
+    static constexpr size_t hazards_per_slot = 2;
+
+    explicit HazardDomain(size_t slots = 128)
+        : m_slots{ slots }
+    {}
+    HazardDomain(const HazardDomain&)            = delete;
+    HazardDomain& operator=(const HazardDomain&) = delete;
+    // Every guard must be gone; whatever is still retired is deleted.
+    ~HazardDomain();
+
+    Guard pin() { return Guard{ *this }; }
+
+    size_t pending() const { return m_pending.load(std::memory_order_relaxed); }
+
+    size_t scan_threshold() const
+    {
+        return 2 * m_slots.size() * hazards_per_slot;
+    }
+
+    size_t max_pending() const { return m_slots.size() * scan_threshold(); }
+
+private:
+    friend class reclaim::Guard<HazardDomain>;
+
+    struct alignas(64) Slot
+    {
+        std::atomic<bool>    in_use{ false };
+        std::atomic<void*>   hazards[hazards_per_slot]{};
+        std::vector<Retired> retired{};
+    };
+
+    SlotTable<Slot>                 m_slots;
+    alignas(64) std::atomic<size_t> m_pending{ 0 };
+
+    Slot& enter() { return *m_slots.claim(); }
+
+    void leave(Slot& slot) noexcept
+    {
+        for (auto& hazard : slot.hazards)
+            hazard.store(nullptr, std::memory_order_release);
+        m_slots.unclaim(&slot);
+    }
+
+    // Publishes the pointer, then re-reads the source: if it still holds
+    // the same pointer, no scan that started after the unlink can miss it.
+    template <class T>
+    T* protect(Slot& slot, const std::atomic<T*>& source, size_t index)
+    {
+        assert(index < hazards_per_slot);
+        T* ptr = source.load(std::memory_order_relaxed);
+        while (true)
+        {
+            slot.hazards[index].store(ptr, std::memory_order_seq_cst);
+            T* again = source.load(std::memory_order_seq_cst);
+            if (again == ptr)
+                return ptr;
+            ptr = again;
+        }
+    }
+
+    template <class T, class Deleter>
+    void retire(Slot& slot, T* ptr, Deleter deleter)
+    {
+        Retired::push(slot.retired, ptr, std::move(deleter), 0);
+        m_pending.fetch_add(1, std::memory_order_relaxed);
+
+        if (slot.retired.size() >= scan_threshold())
+            scan(slot);
+    }
+
+    // Orphaned lists are adopted before the hazards are read, so every
+    // object scanned was retired before the snapshot.
+    void scan(Slot& slot)
+    {
+        m_slots.adopt_orphans(slot);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::vector<void*> hazards;
+        hazards.reserve(m_slots.size() * hazards_per_slot);
+        for (size_t i{ 0 }; i < m_slots.size(); ++i)
+        {
+            for (auto& hazard : m_slots[i].hazards)
+            {
+                if (void* ptr = hazard.load(std::memory_order_acquire))
+                    hazards.push_back(ptr);
+            }
+        }
+        std::sort(hazards.begin(), hazards.end());
+
+        size_t kept = 0;
+        for (const Retired& retired : slot.retired)
+        {
+            if (std::binary_search(hazards.begin(), hazards.end(), retired.ptr))
+                slot.retired[kept++] = retired;
+            else
+                retired.reclaim();
+        }
+
+        m_pending.fetch_sub(
+            slot.retired.size() - kept, std::memory_order_relaxed
+        );
+        slot.retired.resize(kept);
+    }
+};
+
+inline HazardDomain::~HazardDomain()
+{
+    for (size_t i{ 0 }; i < m_slots.size(); ++i)
+    {
+        assert(!m_slots[i].in_use.load());
+        for (const Retired& retired : m_slots[i].retired)
+            retired.reclaim();
+    }
+}
+
+}   // namespace reclaim
+
+// Lock-free stack used to exercise both domains.
+template <class Domain>
+class TreiberStack
+{
+private:
+    struct Node
+    {
+        int   value;
+        Node* next;
+    };
+
+    Domain&            m_domain;
+    std::atomic<Node*> m_head{ nullptr };
+
+public:
+    explicit TreiberStack(Domain& domain)
+        : m_domain{ domain }
+    {}
+    ~TreiberStack()
+    {
+        Node* node = m_head.load();
+        while (node)
+            delete std::exchange(node, node->next);
+    }
+
+    void push(int value)
+    {
+        Node* node = new Node{ value, m_head.load(std::memory_order_relaxed) };
+        while (!m_head.compare_exchange_weak(
+            node->next, node, std::memory_order_release,
+            std::memory_order_relaxed
+        ))
+        {}
+    }
+
+    std::optional<int> pop()
+    {
+        auto guard = m_domain.pin();
+        while (true)
+        {
+            Node* head = guard.protect(m_head);
+            if (!head)
+                return std::nullopt;
+
+            if (m_head.compare_exchange_weak(
+                    head, head->next, std::memory_order_acquire,
+                    std::memory_order_relaxed
+                ))
+            {
+                int value = head->value;
+                guard.retire(head);
+                return value;
+            }
+        }
+    }
+};
+
+template <class Domain>
+void test_stack(Domain& domain)
+{
+    constexpr int threads   = 4;
+    constexpr int perThread = 50000;
+
+    TreiberStack<Domain>     stack{ domain };
+    std::atomic<long>        popped{ 0 };
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back(
+            [&, t]
+            {
+                for (int i = 0; i < perThread; ++i)
+                {
+                    stack.push(t * perThread + i);
+                    if (auto value = stack.pop())
+                        popped += *value;
+                }
+            }
+        );
+    }
+    for (auto& worker : workers)
+        worker.join();
+
+    while (auto value = stack.pop())
+        popped += *value;
+
+    long n = static_cast<long>(threads) * perThread;
+    assert(popped == n * (n - 1) / 2);
+}
+
+int main()
+{
+    using namespace reclaim;
+
+    // Epochs: retired objects wait two epochs, then go
+    {
+        static int deleted = 0;
+        struct Counted
+        {
+            ~Counted() { ++deleted; }
+        };
+
+        EpochDomain domain{ 4 };
+        for (size_t i = 0; i < 10 * EpochDomain::collect_threshold; ++i)
+        {
+            auto guard = domain.pin();
+            guard.retire(new Counted);
+        }
+        assert(deleted > 0);
+        assert(domain.pending() <= 3 * EpochDomain::collect_threshold);
+    }
+
+    // Hazard pointers: a protected object survives any number of scans
+    {
+        HazardDomain      domain{ 2 };
+        std::atomic<int*> shared{ new int{ 42 } };
+
+        auto reader = domain.pin();
+        int* seen   = reader.protect(shared);
+        {
+            auto writer = domain.pin();
+            writer.retire(shared.exchange(nullptr));
+            for (size_t i = 0; i < 3 * domain.scan_threshold(); ++i)
+                writer.retire(new int{ 0 });
+            assert(domain.pending() <= domain.max_pending());
+        }
+        assert(*seen == 42);
+    }
+
+    // Stateful deleters are kept until the object is reclaimed
+    {
+        int reclaimed = 0;
+        {
+            HazardDomain domain{ 1 };
+            auto         guard = domain.pin();
+            guard.retire(
+                new int{ 7 },
+                [&reclaimed](int* ptr)
+                {
+                    reclaimed += *ptr;
+                    delete ptr;
+                }
+            );
+        }
+        assert(reclaimed == 7);
+    }
+
+    // A full slot table throws instead of waiting on itself
+    {
+        EpochDomain domain{ 2 };
+        auto        first  = domain.pin();
+        auto        second = domain.pin();
+        bool        threw  = false;
+        try
+        {
+            auto third = domain.pin();
+        }
+        catch (const std::length_error&)
+        {
+            threw = true;
+        }
+        assert(threw);
+    }
+
+    // Lists left behind by exited threads are reclaimed by later scans
+    {
+        static int orphans = 0;
+        struct Orphan
+        {
+            ~Orphan() { ++orphans; }
+        };
+
+        auto leave_orphans = [](auto& domain)
+        {
+            // Holding a guard here sends the thread to the other slot.
+            {
+                auto held = domain.pin();
+                std::thread{ [&]
+                             {
+                                 auto guard = domain.pin();
+                                 for (int i = 0; i < 3; ++i)
+                                     guard.retire(new Orphan);
+                             } }
+                    .join();
+            }
+            for (int i = 0; i < 1000; ++i)
+                domain.pin().retire(new int{ i });
+        };
+
+        EpochDomain epochs{ 2 };
+        leave_orphans(epochs);
+        assert(orphans == 3);
+
+        HazardDomain hazards{ 2 };
+        leave_orphans(hazards);
+        assert(orphans == 6);
+    }
+
+    // Concurrent push/pop under both schemes
+    {
+        EpochDomain epochs;
+        test_stack(epochs);
+
+        HazardDomain hazards;
+        test_stack(hazards);
+        assert(hazards.pending() <= hazards.max_pending());
+    }
+
+    std::cout << "All tests passed.\n";
+    return 0;
+}
@@ -1,27 +1,148 @@
+#ifndef SEMAPHORE_CPP
+#define SEMAPHORE_CPP
+
 #include <atomic>
+#include <cassert>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <mutex>
 
-// Counting semaphore implementation
+#include "mutex.cpp"
+
+// Counting semaphore. An uncontended acquire or release is a single
+// atomic read-modify-write on the count and never enters the kernel. An
+// acquire that finds too few permits spins briefly, then registers as a
+// waiter and parks on the count through a futex; release only wakes when
+// a waiter is registered. Permits can be taken and returned in batches,
+// and a batch is taken all at once or not at all.
 class CountSemaphore
 {
 public:
     CountSemaphore(int count = 1)
-        : m_count(count)
-    {}
+        : m_count(static_cast<uint32_t>(count))
+    {
+        assert(count >= 0 && "initial count must not be negative");
+    }
+    CountSemaphore(const CountSemaphore&)            = delete;
+    CountSemaphore& operator=(const CountSemaphore&) = delete;
 
-    void acquire()
+    void acquire() { acquire_many(1); }
+
+    void acquire_many(uint32_t n)
     {
-        while (m_count.fetch_sub(1, std::memory_order_acquire) <= 0)
+        if (!try_acquire_many(n))
+            wait_for_permits(
+                n,
+                [this](uint32_t count)
+                {
+                    futex_wait(m_count, count);
+                    return true;
+                }
+            );
+    }
+
+    bool try_acquire() { return try_acquire_many(1); }
+
+    bool try_acquire_many(uint32_t n)
+    {
+        uint32_t count = m_count.load(std::memory_order_relaxed);
+        while (count >= n)
         {
-            m_count.fetch_add(1, std::memory_order_relaxed);
+            if (m_count.compare_exchange_weak(
+                    count, count - n, std::memory_order_acquire,
+                    std::memory_order_relaxed
+                ))
+                return true;
         }
+        return false;
     }
 
-    void release() { m_count.fetch_add(1, std::memory_order_release); }
+    template <typename Rep, typename Period>
+    bool try_acquire_for(const std::chrono::duration<Rep, Period>& timeout)
+    {
+        return try_acquire_until(std::chrono::steady_clock::now() + timeout);
+    }
+
+    template <typename Clock, typename Duration>
+    bool try_acquire_until(
+        const std::chrono::time_point<Clock, Duration>& deadline
+    )
+    {
+        if (try_acquire())
+            return true;
+
+        return wait_for_permits(
+            1,
+            [&](uint32_t count)
+            {
+                auto remaining = std::chrono::ceil<std::chrono::nanoseconds>(
+                    deadline - Clock::now()
+                );
+                if (remaining <= std::chrono::nanoseconds::zero())
+                    return false;
+                futex_wait_for(m_count, count, remaining);
+                return true;
+            }
+        );
+    }
+
+    void release(uint32_t n = 1)
+    {
+        m_count.fetch_add(n, std::memory_order_seq_cst);
+        uint64_t waiters = m_waiters.load(std::memory_order_seq_cst);
+        if (waiters == 0)
+            return;
+
+        // A batch waiter woken for too few permits would go back to sleep
+        // and swallow the wake, so wake everyone when one may be parked.
+        if (n == 1 && waiters < batch_waiter)
+            futex_wake_one(m_count);
+        else
+            futex_wake_all(m_count);
+    }
 
 private:
-    std::atomic<int> m_count;
+    // m_waiters counts single-permit waiters in its low 32 bits and batch
+    // waiters in its high 32 bits, so neither can carry into the other.
+    static constexpr uint64_t batch_waiter = uint64_t{ 1 } << 32;
+
+    static constexpr int spin_rounds = 100;
+
+    std::atomic<uint32_t> m_count;
+    std::atomic<uint64_t> m_waiters{ 0 };
+
+    // Spins, then parks until n permits are taken or park(count) reports
+    // that the caller has given up. park is called with the count seen
+    // last and must block only while the count still holds that value.
+    template <typename Park>
+    bool wait_for_permits(uint32_t n, Park park)
+    {
+        for (int round = 0; round < spin_rounds; ++round)
+        {
+            if (m_count.load(std::memory_order_relaxed) >= n &&
+                try_acquire_many(n))
+                return true;
+            cpu_relax();
+        }
+
+        uint64_t unit = n == 1 ? 1 : batch_waiter;
+        m_waiters.fetch_add(unit, std::memory_order_seq_cst);
+        bool acquired = false;
+        while (true)
+        {
+            uint32_t count = m_count.load(std::memory_order_seq_cst);
+            if (count >= n && try_acquire_many(n))
+            {
+                acquired = true;
+                break;
+            }
+            if (count < n && !park(count))
+                break;
+        }
+        m_waiters.fetch_sub(unit, std::memory_order_relaxed);
+        return acquired;
+    }
 };
 
 // Await/Notify Semaphore implementation
@@ -39,6 +160,15 @@ public:
         --m_count;
     }
 
+    bool try_acquire()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_count <= 0)
+            return false;
+        --m_count;
+        return true;
+    }
+
     void release()
     {
         std::unique_lock<std::mutex> lock(m_mutex);
@@ -51,3 +181,5 @@ private:
     std::mutex              m_mutex;
     std::condition_variable m_cv;
 };
+
+#endif   // SEMAPHORE_CPP
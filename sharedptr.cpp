@@ -1,22 +1,180 @@
 
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <iostream>
-#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
-struct ControlBlock
+// Reference counting policies. AtomicPolicy counts can be shared across
+// threads: increments are relaxed (a new owner can only come from an
+// existing one), and the acq_rel decrements order every owner's use of the
+// object before its destruction. LocalPolicy counts are plain integers for
+// pointers that never leave one thread, so a copy costs a bare ++/--.
+struct AtomicPolicy
 {
-    size_t             m_count{ 0 };
-    mutable std::mutex m_mutex;
+    using Count = std::atomic<size_t>;
 
-    explicit ControlBlock(size_t count)
-        : m_count{ count }, m_mutex{}
+    static constexpr bool thread_safe = true;
+
+    static size_t load(const Count& count) noexcept
+    {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    static void increment(Count& count) noexcept
+    {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Returns the count left after the decrement.
+    static size_t decrement(Count& count) noexcept
+    {
+        return count.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    }
+
+    static bool increment_if_nonzero(Count& count) noexcept
+    {
+        size_t current = count.load(std::memory_order_relaxed);
+        while (current != 0)
+        {
+            if (count.compare_exchange_weak(
+                    current, current + 1, std::memory_order_acq_rel,
+                    std::memory_order_relaxed
+                ))
+                return true;
+        }
+        return false;
+    }
+};
+
+struct LocalPolicy
+{
+    using Count = size_t;
+
+    static constexpr bool thread_safe = false;
+
+    static size_t load(const Count& count) noexcept { return count; }
+    static void   increment(Count& count) noexcept { ++count; }
+    static size_t decrement(Count& count) noexcept { return --count; }
+
+    static bool increment_if_nonzero(Count& count) noexcept
+    {
+        if (count == 0)
+            return false;
+        ++count;
+        return true;
+    }
+};
+
+// Shared by every SharedPointer and WeakPointer to the same object.
+//
+// m_count is the number of SharedPointers. m_weak is the number of
+// WeakPointers plus one held jointly by all SharedPointers, so the block
+// outlives the object for as long as anyone can still observe it.
+template <typename Policy>
+struct alignas(16) BasicControlBlock
+{
+    typename Policy::Count m_count{ 0 };
+    typename Policy::Count m_weak{ 1 };
+
+    explicit BasicControlBlock(size_t count)
+        : m_count{ count }
+    {}
+    virtual ~BasicControlBlock() = default;
+
+    virtual void* object() noexcept = 0;
+    // Destroys the object once the last SharedPointer lets go.
+    virtual void dispose() noexcept = 0;
+    // Frees the block once the last WeakPointer lets go.
+    virtual void destroy() noexcept { delete this; }
+
+    void add_strong() noexcept { Policy::increment(m_count); }
+    void add_weak() noexcept { Policy::increment(m_weak); }
+
+    void release_strong() noexcept
+    {
+        if (Policy::decrement(m_count) == 0)
+        {
+            dispose();
+            release_weak();
+        }
+    }
+
+    void release_weak() noexcept
+    {
+        if (Policy::decrement(m_weak) == 0)
+            destroy();
+    }
+
+    // Adds a SharedPointer unless the object is already gone.
+    bool try_add_strong() noexcept
+    {
+        return Policy::increment_if_nonzero(m_count);
+    }
+
+    size_t strong_count() const noexcept { return Policy::load(m_count); }
+};
+
+using ControlBlock = BasicControlBlock<AtomicPolicy>;
+
+// Control block for an object allocated separately by the caller.
+template <typename T, typename Policy>
+struct PointerControlBlock : BasicControlBlock<Policy>
+{
+    T* m_ptr;
+
+    explicit PointerControlBlock(T* ptr)
+        : BasicControlBlock<Policy>{ 1 }, m_ptr{ ptr }
     {}
+
+    void* object() noexcept override { return m_ptr; }
+    void  dispose() noexcept override { delete m_ptr; }
 };
 
+// Control block with the object stored inline, so make_shared_pointer
+// needs a single allocation. The object is destroyed with the last
+// SharedPointer; the memory goes with the last WeakPointer.
+template <typename T, typename Policy>
+struct InplaceControlBlock : BasicControlBlock<Policy>
+{
+    alignas(T) unsigned char m_storage[sizeof(T)];
+
+    template <typename... Args>
+    explicit InplaceControlBlock(Args&&... args)
+        : BasicControlBlock<Policy>{ 1 }
+    {
+        new (m_storage) T(std::forward<Args>(args)...);
+    }
+
+    T* get() noexcept { return std::launder(reinterpret_cast<T*>(m_storage)); }
+
+    void* object() noexcept override { return get(); }
+    void  dispose() noexcept override { get()->~T(); }
+};
+
+// Control block that holds one reference under another policy, used when
+// a pointer is explicitly converted from an atomic to a local policy. The
+// two groups of owners keep separate counts; the source reference goes
+// when this block's last owner does, on the local group's thread.
+template <typename T, typename Policy, typename Source>
+struct BridgeControlBlock;
+
+template <typename T, typename Policy = AtomicPolicy>
+class WeakPointer;
+
 template <typename T>
+class AtomicSharedPointer;
+
+template <typename T, typename Policy = AtomicPolicy>
 class SharedPointer
 {
+    using Block = BasicControlBlock<Policy>;
+
 public:
     SharedPointer()
         : SharedPointer(nullptr)
@@ -25,9 +183,28 @@ public:
         : m_ptr{ nullptr }, m_controlBlock{ nullptr }
     {}
     explicit SharedPointer(T* ptr)
-        : m_ptr{ ptr }, m_controlBlock{ new ControlBlock{ 1 } }
+        : m_ptr{ ptr }, m_controlBlock{ make_block(ptr) }
     {}
 
+    // Shares ownership with a pointer under another policy. The conversion
+    // allocates a bridging block, so it is explicit and meant to be done
+    // once at a thread boundary rather than per copy. Only a thread-safe
+    // group may feed a thread-confined one: a bridge from a local group
+    // into an atomic one would drop its local reference on whichever
+    // thread releases the last atomic owner, racing with the local copies.
+    template <typename Source>
+        requires(!std::is_same_v<Source, Policy> &&
+                 (Source::thread_safe || !Policy::thread_safe))
+    explicit SharedPointer(const SharedPointer<T, Source>& other)
+    {
+        if (other.m_controlBlock)
+        {
+            using Bridge   = BridgeControlBlock<T, Policy, Source>;
+            m_controlBlock = new Bridge{ other };
+            m_ptr          = other.m_ptr;
+        }
+    }
+
     SharedPointer(const SharedPointer& other) { copy(other); }
     SharedPointer& operator=(const SharedPointer& other)
     {
@@ -58,8 +235,8 @@ public:
 
         if (ptr)
         {
+            m_controlBlock = make_block(ptr);
             m_ptr          = ptr;
-            m_controlBlock = new ControlBlock{ 1 };
         }
     }
 
@@ -73,8 +250,7 @@ public:
 
     size_t get_count() const
     {
-        std::lock_guard<std::mutex> lock(m_controlBlock->m_mutex);
-        return m_controlBlock->m_count;
+        return m_controlBlock ? m_controlBlock->strong_count() : 0;
     }
 
     T* get() const { return m_ptr; }
@@ -83,48 +259,354 @@ public:
     operator bool() const noexcept { return m_ptr != nullptr; }
 
 private:
-    T*            m_ptr{ nullptr };
-    ControlBlock* m_controlBlock{ nullptr };
+    T*     m_ptr{ nullptr };
+    Block* m_controlBlock{ nullptr };
+
+    template <typename U, typename P, typename... Args>
+    friend SharedPointer<U, P> make_shared_pointer(Args&&... args);
+    template <typename, typename>
+    friend class SharedPointer;
+    friend class WeakPointer<T, Policy>;
+    friend class AtomicSharedPointer<T>;
+
+    SharedPointer(T* ptr, Block* controlBlock)
+        : m_ptr{ ptr }, m_controlBlock{ controlBlock }
+    {}
+
+    static Block* make_block(T* ptr)
+    {
+        try
+        {
+            return new PointerControlBlock<T, Policy>{ ptr };
+        }
+        catch (...)
+        {
+            delete ptr;
+            throw;
+        }
+    }
 
     void copy(const SharedPointer& other) noexcept
     {
-        if (other.m_ptr)
+        if (other.m_controlBlock)
         {
-            std::lock_guard<std::mutex> lock(other.m_controlBlock->m_mutex);
+            other.m_controlBlock->add_strong();
             m_ptr          = other.m_ptr;
             m_controlBlock = other.m_controlBlock;
-            ++m_controlBlock->m_count;
         }
     }
 
     void release() noexcept
     {
-        if (m_ptr)
+        if (m_controlBlock)
+        {
+            std::exchange(m_controlBlock, nullptr)->release_strong();
+            m_ptr = nullptr;
+        }
+    }
+
+    void steal(SharedPointer& other) noexcept
+    {
+        m_ptr          = std::exchange(other.m_ptr, nullptr);
+        m_controlBlock = std::exchange(other.m_controlBlock, nullptr);
+    }
+};
+
+// Pointers whose counts are never touched by more than one thread.
+template <typename T>
+using LocalSharedPointer = SharedPointer<T, LocalPolicy>;
+
+template <typename T>
+using LocalWeakPointer = WeakPointer<T, LocalPolicy>;
+
+template <typename T, typename Policy, typename Source>
+struct BridgeControlBlock : BasicControlBlock<Policy>
+{
+    SharedPointer<T, Source> m_source;
+
+    explicit BridgeControlBlock(const SharedPointer<T, Source>& source)
+        : BasicControlBlock<Policy>{ 1 }, m_source{ source }
+    {}
+
+    void* object() noexcept override { return m_source.get(); }
+    void  dispose() noexcept override { m_source.reset(); }
+};
+
+// Allocates the object and its control block together. Named apart from
+// std::make_shared so calls with std:: argument types stay unambiguous.
+template <typename T, typename Policy = AtomicPolicy, typename... Args>
+SharedPointer<T, Policy> make_shared_pointer(Args&&... args)
+{
+    auto* block =
+        new InplaceControlBlock<T, Policy>(std::forward<Args>(args)...);
+    return SharedPointer<T, Policy>{ block->get(), block };
+}
+
+template <typename T, typename... Args>
+LocalSharedPointer<T> make_local_shared_pointer(Args&&... args)
+{
+    return make_shared_pointer<T, LocalPolicy>(std::forward<Args>(args)...);
+}
+
+// Non-owning observer of a SharedPointer-managed object. lock() takes a
+// new strong reference with a CAS loop, never a lock, and fails once the
+// object has been destroyed.
+template <typename T, typename Policy>
+class WeakPointer
+{
+    using Block = BasicControlBlock<Policy>;
+
+public:
+    WeakPointer() = default;
+    WeakPointer(const SharedPointer<T, Policy>& shared) noexcept
+        : m_ptr{ shared.m_ptr }, m_controlBlock{ shared.m_controlBlock }
+    {
+        add_weak();
+    }
+
+    WeakPointer(const WeakPointer& other) noexcept
+        : m_ptr{ other.m_ptr }, m_controlBlock{ other.m_controlBlock }
+    {
+        add_weak();
+    }
+    WeakPointer& operator=(const WeakPointer& other) noexcept
+    {
+        WeakPointer{ other }.swap(*this);
+        return *this;
+    }
+
+    WeakPointer(WeakPointer&& other) noexcept
+        : m_ptr{ std::exchange(other.m_ptr, nullptr) },
+          m_controlBlock{ std::exchange(other.m_controlBlock, nullptr) }
+    {}
+    WeakPointer& operator=(WeakPointer&& other) noexcept
+    {
+        WeakPointer{ std::move(other) }.swap(*this);
+        return *this;
+    }
+
+    ~WeakPointer() { reset(); }
+
+    void reset() noexcept
+    {
+        if (m_controlBlock)
+            std::exchange(m_controlBlock, nullptr)->release_weak();
+        m_ptr = nullptr;
+    }
+
+    void swap(WeakPointer& other) noexcept
+    {
+        std::swap(m_ptr, other.m_ptr);
+        std::swap(m_controlBlock, other.m_controlBlock);
+    }
+
+    SharedPointer<T, Policy> lock() const noexcept
+    {
+        if (m_controlBlock && m_controlBlock->try_add_strong())
+            return SharedPointer<T, Policy>{ m_ptr, m_controlBlock };
+        return SharedPointer<T, Policy>{};
+    }
+
+    bool expired() const noexcept { return get_count() == 0; }
+
+    size_t get_count() const noexcept
+    {
+        return m_controlBlock ? m_controlBlock->strong_count() : 0;
+    }
+
+private:
+    T*     m_ptr{ nullptr };
+    Block* m_controlBlock{ nullptr };
+
+    void add_weak() noexcept
+    {
+        if (m_controlBlock)
+            m_controlBlock->add_weak();
+    }
+};
+
+// Atomic slot holding a SharedPointer, for publishing read-mostly data to
+// many readers without a lock.
+//
+// The slot is one 64-bit word packing the 48-bit control block pointer, an
+// 8-bit tag bumped on every store (4 bits below the pointer, which the
+// block's alignment leaves free, and 4 above it), and in the top 12 bits
+// a count of loads in flight. load() bumps that local count (which pins
+// the block), takes a real strong reference, then hands the local share
+// back with a CAS. A writer that swaps the block out first adds the local
+// count to the block's strong count, so readers that find the slot
+// changed return their share there instead.
+//
+// The tag keeps a reader from mistaking a re-stored block for the one it
+// pinned, as long as fewer than 256 stores land while it is preempted
+// between its two steps; at most 4095 loads may be in flight at once.
+template <typename T>
+class AtomicSharedPointer
+{
+    static_assert(sizeof(void*) == 8, "Needs 64-bit pointers");
+
+private:
+    using Word = std::uint64_t;
+
+    static constexpr unsigned local_shift   = 52;
+    static constexpr Word     one_local     = Word{ 1 } << local_shift;
+    static constexpr Word     max_in_flight = (Word{ 1 } << 12) - 1;
+    static constexpr Word     address_mask  = (Word{ 1 } << 48) - 1;
+    static constexpr Word     identity_mask = one_local - 1;
+    static constexpr Word     pointer_mask =
+        address_mask & ~Word{ alignof(ControlBlock) - 1 };
+    static constexpr Word tag_mask = identity_mask & ~pointer_mask;
+
+    static_assert(alignof(ControlBlock) == 16, "Tag layout assumes 4 bits");
+
+    mutable std::atomic<Word> m_word{ 0 };
+
+    static ControlBlock* block(Word word)
+    {
+        return reinterpret_cast<ControlBlock*>(word & pointer_mask);
+    }
+
+    // The word for desired's control block with the tag after previous's.
+    // Filling the pointer bits with ones carries the increment from the
+    // low tag bits into the high ones.
+    static Word next_word(const SharedPointer<T>& desired, Word previous)
+    {
+        auto bits = reinterpret_cast<Word>(desired.m_controlBlock);
+        assert((bits & ~pointer_mask) == 0);
+        return bits | (((previous | pointer_mask) + 1) & tag_mask);
+    }
+
+    // The slot's reference now belongs to the returned pointer.
+    static void disown(SharedPointer<T>& desired)
+    {
+        desired.m_ptr          = nullptr;
+        desired.m_controlBlock = nullptr;
+    }
+
+    // Turns a word removed from the slot back into an owning pointer,
+    // crediting the block with the shares of loads still in flight.
+    static SharedPointer<T> adopt(Word word)
+    {
+        ControlBlock* cb = block(word);
+        if (!cb)
+            return {};
+
+        if (Word inFlight = word >> local_shift)
+            cb->m_count.fetch_add(inFlight, std::memory_order_relaxed);
+        return SharedPointer<T>{ static_cast<T*>(cb->object()), cb };
+    }
+
+    // Pins the current word by bumping its local count, returning the word
+    // as it was before.
+    Word pin() const
+    {
+        Word pinned = m_word.fetch_add(one_local, std::memory_order_acquire);
+        assert((pinned >> local_shift) < max_in_flight);
+        return pinned;
+    }
+
+    // Turns a word pinned by pin() into an owning pointer and hands the
+    // local share back.
+    SharedPointer<T> take_pinned(Word pinned) const
+    {
+        ControlBlock* cb = block(pinned);
+        if (cb)
+            cb->m_count.fetch_add(1, std::memory_order_relaxed);
+
+        Word expected = pinned + one_local;
+        while ((expected & identity_mask) == (pinned & identity_mask))
+        {
+            assert(
+                (expected >> local_shift) != 0 &&
+                "Slot re-stored 256 times under a pinned load"
+            );
+            if (m_word.compare_exchange_weak(
+                    expected, expected - one_local, std::memory_order_release,
+                    std::memory_order_relaxed
+                ))
+                return SharedPointer<T>{
+                    cb ? static_cast<T*>(cb->object()) : nullptr, cb
+                };
+        }
+
+        // The slot moved on and our local share was credited to the block;
+        // give it back there. Our own reference keeps the count above zero.
+        if (cb)
+        {
+            [[maybe_unused]] size_t before =
+                cb->m_count.fetch_sub(1, std::memory_order_relaxed);
+            assert(before > 1);
+        }
+        return SharedPointer<T>{
+            cb ? static_cast<T*>(cb->object()) : nullptr, cb
+        };
+    }
+
+public:
+    AtomicSharedPointer() = default;
+    explicit AtomicSharedPointer(SharedPointer<T> desired)
+        : m_word{ next_word(desired, tag_mask) }
+    {
+        disown(desired);
+    }
+    AtomicSharedPointer(const AtomicSharedPointer&)            = delete;
+    AtomicSharedPointer& operator=(const AtomicSharedPointer&) = delete;
+    ~AtomicSharedPointer() { adopt(m_word.load(std::memory_order_acquire)); }
+
+    SharedPointer<T> load() const { return take_pinned(pin()); }
+
+    void store(SharedPointer<T> desired) { exchange(std::move(desired)); }
+
+    SharedPointer<T> exchange(SharedPointer<T> desired)
+    {
+        Word previous = m_word.load(std::memory_order_relaxed);
+        while (!m_word.compare_exchange_weak(
+            previous, next_word(desired, previous), std::memory_order_acq_rel,
+            std::memory_order_relaxed
+        ))
+        {}
+
+        disown(desired);
+        return adopt(previous);
+    }
+
+    // Replaces the slot with desired if it still holds expected's object;
+    // otherwise stores the value it held into expected. The mismatch is
+    // decided on a pinned word, so expected gets exactly the value that
+    // failed the compare.
+    bool compare_exchange_strong(
+        SharedPointer<T>& expected, SharedPointer<T> desired
+    )
+    {
+        Word previous = m_word.load(std::memory_order_relaxed);
+        while (true)
         {
-            bool          deletePtr{ false };
-            ControlBlock* cb = m_controlBlock;
+            if (block(previous) == expected.m_controlBlock)
             {
-                std::lock_guard<std::mutex> lock(cb->m_mutex);
-                if (--cb->m_count == 0)
+                if (m_word.compare_exchange_weak(
+                        previous, next_word(desired, previous),
+                        std::memory_order_acq_rel, std::memory_order_relaxed
+                    ))
                 {
-                    deletePtr = true;
+                    disown(desired);
+                    adopt(previous);
+                    return true;
                 }
+                continue;
             }
 
-            if (deletePtr)
+            Word pinned = pin();
+            if (block(pinned) != expected.m_controlBlock)
             {
-                delete m_ptr;
-                delete cb;
+                expected = take_pinned(pinned);
+                return false;
             }
-            m_ptr          = nullptr;
-            m_controlBlock = nullptr;
-        }
-    }
 
-    void steal(SharedPointer& other) noexcept
-    {
-        m_ptr          = std::exchange(other.m_ptr, nullptr);
-        m_controlBlock = std::exchange(other.m_controlBlock, nullptr);
+            // It changed back to expected's object after all; drop the pin
+            // (expected's own reference keeps the block alive) and retry.
+            take_pinned(pinned);
+            previous = m_word.load(std::memory_order_relaxed);
+        }
     }
 };
 
@@ -190,6 +672,205 @@ int main()
     sp6.swap(sp7);
     std::cout << "After swap: sp6 = " << *sp6 << ", sp7 = " << *sp7 << "\n";
 
+    // Test make_shared_pointer with a single allocation.
+    SharedPointer<std::string> sp8 = make_shared_pointer<std::string>(3, 'x');
+    assert(*sp8 == "xxx");
+    assert(sp8.get_count() == 1);
+    SharedPointer<std::string> sp9(sp8);
+    assert(sp9.get_count() == 2);
+    sp8.reset();
+    assert(sp9.get_count() == 1 && sp9->size() == 3);
+    std::cout << "make_shared_pointer value: " << *sp9 << "\n";
+
+    // Test WeakPointer observing without owning.
+    WeakPointer<std::string> weak;
+    {
+        SharedPointer<std::string> owner =
+            make_shared_pointer<std::string>("cached");
+        weak = owner;
+        assert(!weak.expired());
+        assert(weak.get_count() == 1);
+
+        SharedPointer<std::string> locked = weak.lock();
+        assert(locked && *locked == "cached");
+        assert(owner.get_count() == 2);
+    }
+    assert(weak.expired());
+    assert(!weak.lock());
+    std::cout << "WeakPointer expired after last owner: "
+              << (weak.expired() ? "yes" : "no") << "\n";
+
+    // Test that the object dies with the last strong reference even while
+    // weak references keep the block alive.
+    {
+        static int destroyed = 0;
+        struct Tracked
+        {
+            ~Tracked() { ++destroyed; }
+        };
+
+        SharedPointer<Tracked> owner = make_shared_pointer<Tracked>();
+        WeakPointer<Tracked>   observer(owner);
+        WeakPointer<Tracked>   copy(observer);
+        owner.reset();
+        assert(destroyed == 1);
+        assert(copy.expired());
+    }
+
+    // Test AtomicSharedPointer load/store/exchange/compare_exchange.
+    {
+        AtomicSharedPointer<int> slot{ make_shared_pointer<int>(1) };
+        SharedPointer<int>       first = slot.load();
+        assert(*first == 1 && first.get_count() == 2);
+
+        slot.store(make_shared_pointer<int>(2));
+        assert(*slot.load() == 2);
+        assert(first.get_count() == 1);
+
+        SharedPointer<int> old = slot.exchange(make_shared_pointer<int>(3));
+        assert(*old == 2 && old.get_count() == 1);
+
+        SharedPointer<int> expected = first;
+        assert(!slot.compare_exchange_strong(expected, old));
+        assert(*expected == 3);
+        assert(slot.compare_exchange_strong(expected, old));
+        assert(*slot.load() == 2);
+        std::cout << "AtomicSharedPointer now holds " << *slot.load() << "\n";
+    }
+
+    // Test that the tag wraps through its high bits without touching the
+    // pointer when the same block is stored over and over.
+    {
+        SharedPointer<int>       value = make_shared_pointer<int>(7);
+        AtomicSharedPointer<int> slot{ value };
+        for (int i = 0; i < 1000; ++i)
+            slot.store(value);
+        assert(slot.load().get() == value.get());
+        assert(value.get_count() == 2);
+    }
+
+    // Test readers racing a writer that keeps swapping the slot.
+    {
+        static std::atomic<int> alive{ 0 };
+        struct Config
+        {
+            int version;
+            explicit Config(int v)
+                : version{ v }
+            {
+                ++alive;
+            }
+            ~Config() { --alive; }
+        };
+
+        AtomicSharedPointer<Config> slot{ make_shared_pointer<Config>(0) };
+        std::atomic<bool>           done{ false };
+        std::vector<std::thread>    readers;
+        for (int r = 0; r < 4; ++r)
+        {
+            readers.emplace_back(
+                [&]
+                {
+                    int last = 0;
+                    while (!done.load())
+                    {
+                        SharedPointer<Config> config = slot.load();
+                        assert(config->version >= last);
+                        last = config->version;
+                    }
+                }
+            );
+        }
+
+        for (int version = 1; version <= 2000; ++version)
+            slot.store(make_shared_pointer<Config>(version));
+        done = true;
+        for (auto& reader : readers)
+            reader.join();
+
+        assert(slot.load()->version == 2000);
+        assert(alive == 1);
+    }
+
+    // Test that a failed compare_exchange reports the value it failed on,
+    // so racing increments are never lost.
+    {
+        AtomicSharedPointer<int> counter{ make_shared_pointer<int>(0) };
+        std::vector<std::thread> writers;
+        for (int w = 0; w < 4; ++w)
+        {
+            writers.emplace_back(
+                [&]
+                {
+                    SharedPointer<int> expected = counter.load();
+                    for (int i = 0; i < 1000; ++i)
+                    {
+                        while (true)
+                        {
+                            SharedPointer<int> seen = expected;
+                            if (counter.compare_exchange_strong(
+                                    expected,
+                                    make_shared_pointer<int>(*expected + 1)
+                                ))
+                                break;
+                            assert(expected && expected.get() != seen.get());
+                        }
+                        expected = counter.load();
+                    }
+                }
+            );
+        }
+        for (auto& writer : writers)
+            writer.join();
+        assert(*counter.load() == 4000);
+    }
+
+    // Test single-threaded pointers with plain-integer counts.
+    {
+        static_assert(std::is_same_v<LocalPolicy::Count, size_t>);
+
+        LocalSharedPointer<std::string> local =
+            make_local_shared_pointer<std::string>("local");
+        LocalSharedPointer<std::string> copy = local;
+        assert(local.get_count() == 2);
+
+        LocalWeakPointer<std::string> weak(local);
+        copy.reset();
+        assert(local.get_count() == 1 && weak.lock());
+        local.reset();
+        assert(weak.expired());
+    }
+
+    // Test explicit conversion between policies.
+    {
+        static int destroyed = 0;
+        struct Tracked
+        {
+            ~Tracked() { ++destroyed; }
+        };
+
+        SharedPointer<Tracked> shared = make_shared_pointer<Tracked>();
+        {
+            LocalSharedPointer<Tracked> local{ shared };
+            LocalSharedPointer<Tracked> localCopy = local;
+            assert(local.get() == shared.get());
+            assert(shared.get_count() == 2 && local.get_count() == 2);
+
+            shared.reset();
+            assert(destroyed == 0);
+        }
+        assert(destroyed == 1);
+
+        static_assert(!std::is_convertible_v<
+                      SharedPointer<Tracked>, LocalSharedPointer<Tracked>>);
+        static_assert(!std::is_constructible_v<
+                      SharedPointer<Tracked>,
+                      const LocalSharedPointer<Tracked>&>);
+    }
+
+    // Test that the control block no longer carries a mutex.
+    static_assert(sizeof(ControlBlock) <= 4 * sizeof(void*));
+
     std::cout << "All tests passed.\n";
     return 0;
 }
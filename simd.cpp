@@ -0,0 +1,600 @@
+#ifndef SIMD_CPP
+#define SIMD_CPP
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
+// Element-wise kernels over contiguous storage (array::data(),
+// Vector::data(), ...). Each kernel is written once against GCC vector
+// extensions and instantiated per ISA; the widest ISA supported by the CPU
+// is picked at runtime.
+namespace simd
+{
+
+enum class Isa
+{
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+template <typename T>
+concept Element =
+    (std::is_integral_v<T> && !std::is_same_v<T, bool>) ||
+    std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+inline Isa detect_isa()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+        return Isa::AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return Isa::AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return Isa::SSE2;
+#endif
+    return Isa::Scalar;
+}
+
+inline const char* isa_name(Isa isa)
+{
+    switch (isa)
+    {
+    case Isa::SSE2: return "SSE2";
+    case Isa::AVX2: return "AVX2";
+    case Isa::AVX512: return "AVX-512";
+    default: return "Scalar";
+    }
+}
+
+namespace detail
+{
+
+// Read on every kernel call and written by set_isa, possibly from another
+// thread; any ISA the CPU supports gives the same results, so relaxed
+// ordering is enough.
+inline std::atomic<Isa>& selected_isa()
+{
+    static std::atomic<Isa> isa{ detect_isa() };
+    return isa;
+}
+
+// Bytes == 0 selects the plain scalar loops.
+template <typename T, std::size_t Bytes>
+struct Kernel
+{
+    typedef T V __attribute__((vector_size(Bytes)));
+    // Same vector, readable at any element-aligned address and through any
+    // pointer type.
+    typedef T Unaligned
+        __attribute__((vector_size(Bytes), aligned(alignof(T)), may_alias));
+
+    static constexpr std::size_t Lanes = Bytes / sizeof(T);
+
+    // Vectors never cross a function boundary by value, so their ABI
+    // (which depends on the target ISA) never matters.
+    [[gnu::always_inline]] static const Unaligned* at(const T* p)
+    {
+        return reinterpret_cast<const Unaligned*>(p);
+    }
+
+    [[gnu::always_inline]] static Unaligned* at(T* p)
+    {
+        return reinterpret_cast<Unaligned*>(p);
+    }
+
+    // Number of leading elements to handle one by one so that p becomes
+    // aligned to the vector width.
+    [[gnu::always_inline]] static std::size_t head(const T* p, std::size_t n)
+    {
+        auto misalign = reinterpret_cast<std::uintptr_t>(p) % Bytes;
+        auto count    = misalign == 0 ? 0 : (Bytes - misalign) / sizeof(T);
+        return count < n ? count : n;
+    }
+
+    [[gnu::always_inline]] static void fill(T* p, std::size_t n, T value)
+    {
+        std::size_t i = head(p, n);
+        for (std::size_t j{ 0 }; j < i; ++j)
+            p[j] = value;
+
+        V v = V{} + value;
+        for (; i + Lanes <= n; i += Lanes)
+            *at(p + i) = v;
+
+        for (; i < n; ++i)
+            p[i] = value;
+    }
+
+    [[gnu::always_inline]] static T sum(const T* p, std::size_t n)
+    {
+        T           result{};
+        std::size_t i = head(p, n);
+        for (std::size_t j{ 0 }; j < i; ++j)
+            result += p[j];
+
+        V acc0{}, acc1{};
+        for (; i + 2 * Lanes <= n; i += 2 * Lanes)
+        {
+            acc0 += *at(p + i);
+            acc1 += *at(p + i + Lanes);
+        }
+        acc0 += acc1;
+        for (std::size_t k{ 0 }; k < Lanes; ++k)
+            result += acc0[k];
+
+        for (; i < n; ++i)
+            result += p[i];
+        return result;
+    }
+
+    template <bool Min>
+    [[gnu::always_inline]] static T extremum(const T* p, std::size_t n)
+    {
+#define SIMD_PICK(a, b) \
+    (Min ? ((a) < (b) ? (a) : (b)) : ((a) > (b) ? (a) : (b)))
+        T           result = p[0];
+        std::size_t i      = head(p, n);
+        for (std::size_t j{ 0 }; j < i; ++j)
+            result = SIMD_PICK(p[j], result);
+
+        if (i + Lanes <= n)
+        {
+            V acc = *at(p + i);
+            for (i += Lanes; i + Lanes <= n; i += Lanes)
+            {
+                V v = *at(p + i);
+                acc = SIMD_PICK(v, acc);
+            }
+            for (std::size_t k{ 0 }; k < Lanes; ++k)
+                result = SIMD_PICK(acc[k], result);
+        }
+
+        for (; i < n; ++i)
+            result = SIMD_PICK(p[i], result);
+        return result;
+#undef SIMD_PICK
+    }
+
+    [[gnu::always_inline]] static T
+        dot(const T* a, const T* b, std::size_t n)
+    {
+        T           result{};
+        std::size_t i = head(a, n);
+        for (std::size_t j{ 0 }; j < i; ++j)
+            result += a[j] * b[j];
+
+        V acc0{}, acc1{};
+        for (; i + 2 * Lanes <= n; i += 2 * Lanes)
+        {
+            acc0 += *at(a + i) * *at(b + i);
+            acc1 += *at(a + i + Lanes) * *at(b + i + Lanes);
+        }
+        acc0 += acc1;
+        for (std::size_t k{ 0 }; k < Lanes; ++k)
+            result += acc0[k];
+
+        for (; i < n; ++i)
+            result += a[i] * b[i];
+        return result;
+    }
+
+    [[gnu::always_inline]] static std::size_t
+        find(const T* p, std::size_t n, T value)
+    {
+        std::size_t i = head(p, n);
+        for (std::size_t j{ 0 }; j < i; ++j)
+            if (p[j] == value)
+                return j;
+
+        V v = V{} + value;
+        for (; i + Lanes <= n; i += Lanes)
+        {
+            auto mask = *at(p + i) == v;
+            bool any  = false;
+            for (std::size_t k{ 0 }; k < Lanes; ++k)
+                any |= mask[k] != 0;
+            if (any)
+            {
+                for (std::size_t k{ 0 }; k < Lanes; ++k)
+                    if (mask[k])
+                        return i + k;
+            }
+        }
+
+        for (; i < n; ++i)
+            if (p[i] == value)
+                return i;
+        return n;
+    }
+
+    // y[i] += a * x[i]
+    [[gnu::always_inline]] static void
+        scaled_add(T* y, const T* x, T a, std::size_t n)
+    {
+        std::size_t i = head(y, n);
+        for (std::size_t j{ 0 }; j < i; ++j)
+            y[j] += a * x[j];
+
+        V va = V{} + a;
+        for (; i + Lanes <= n; i += Lanes)
+            *at(y + i) += va * *at(x + i);
+
+        for (; i < n; ++i)
+            y[i] += a * x[i];
+    }
+};
+
+template <typename T>
+struct Kernel<T, 0>
+{
+    static void fill(T* p, std::size_t n, T value)
+    {
+        for (std::size_t i{ 0 }; i < n; ++i)
+            p[i] = value;
+    }
+
+    static T sum(const T* p, std::size_t n)
+    {
+        T result{};
+        for (std::size_t i{ 0 }; i < n; ++i)
+            result += p[i];
+        return result;
+    }
+
+    template <bool Min>
+    static T extremum(const T* p, std::size_t n)
+    {
+        T result = p[0];
+        for (std::size_t i{ 1 }; i < n; ++i)
+            result = (Min ? p[i] < result : p[i] > result) ? p[i] : result;
+        return result;
+    }
+
+    static T dot(const T* a, const T* b, std::size_t n)
+    {
+        T result{};
+        for (std::size_t i{ 0 }; i < n; ++i)
+            result += a[i] * b[i];
+        return result;
+    }
+
+    static std::size_t find(const T* p, std::size_t n, T value)
+    {
+        for (std::size_t i{ 0 }; i < n; ++i)
+            if (p[i] == value)
+                return i;
+        return n;
+    }
+
+    static void scaled_add(T* y, const T* x, T a, std::size_t n)
+    {
+        for (std::size_t i{ 0 }; i < n; ++i)
+            y[i] += a * x[i];
+    }
+};
+
+// One entry point per kernel and ISA. The target attribute lets the
+// always_inline bodies above be code-generated for that ISA only.
+#define SIMD_DEFINE_ISA(Name, Target, Bytes)                                  \
+    template <typename T>                                                     \
+    struct Name                                                               \
+    {                                                                         \
+        using K = Kernel<T, Bytes>;                                           \
+        Target static void fill(T* p, std::size_t n, T v)                     \
+        {                                                                     \
+            K::fill(p, n, v);                                                 \
+        }                                                                     \
+        Target static T sum(const T* p, std::size_t n)                        \
+        {                                                                     \
+            return K::sum(p, n);                                              \
+        }                                                                     \
+        Target static T min(const T* p, std::size_t n)                        \
+        {                                                                     \
+            return K::template extremum<true>(p, n);                          \
+        }                                                                     \
+        Target static T max(const T* p, std::size_t n)                        \
+        {                                                                     \
+            return K::template extremum<false>(p, n);                         \
+        }                                                                     \
+        Target static T dot(const T* a, const T* b, std::size_t n)            \
+        {                                                                     \
+            return K::dot(a, b, n);                                           \
+        }                                                                     \
+        Target static std::size_t find(const T* p, std::size_t n, T v)        \
+        {                                                                     \
+            return K::find(p, n, v);                                          \
+        }                                                                     \
+        Target static void scaled_add(T* y, const T* x, T a, std::size_t n)   \
+        {                                                                     \
+            K::scaled_add(y, x, a, n);                                        \
+        }                                                                     \
+    };
+
+SIMD_DEFINE_ISA(ScalarIsa, , 0)
+#if defined(__x86_64__) || defined(__i386__)
+SIMD_DEFINE_ISA(Sse2Isa, [[gnu::target("sse2")]], 16)
+SIMD_DEFINE_ISA(Avx2Isa, [[gnu::target("avx2")]], 32)
+SIMD_DEFINE_ISA(Avx512Isa, [[gnu::target("avx512f,avx512bw")]], 64)
+#endif
+
+#undef SIMD_DEFINE_ISA
+
+template <typename T, typename F>
+decltype(auto) dispatch(F&& f)
+{
+    switch (selected_isa().load(std::memory_order_relaxed))
+    {
+#if defined(__x86_64__) || defined(__i386__)
+    case Isa::AVX512: return f(Avx512Isa<T>{});
+    case Isa::AVX2: return f(Avx2Isa<T>{});
+    case Isa::SSE2: return f(Sse2Isa<T>{});
+#endif
+    default: return f(ScalarIsa<T>{});
+    }
+}
+
+template <typename Container>
+using element_t = std::remove_cvref_t<
+    decltype(*std::declval<Container&>().data())>;
+
+}   // namespace detail
+
+inline Isa active_isa()
+{
+    return detail::selected_isa().load(std::memory_order_relaxed);
+}
+
+// Forces a narrower ISA (e.g. for testing or benchmarking); requests wider
+// than what the CPU supports are clamped.
+inline void set_isa(Isa isa)
+{
+    Isa best = detect_isa();
+    detail::selected_isa().store(
+        isa > best ? best : isa, std::memory_order_relaxed
+    );
+}
+
+template <Element T>
+void fill(T* p, std::size_t n, T value)
+{
+    detail::dispatch<T>([&](auto k) { k.fill(p, n, value); });
+}
+
+template <Element T>
+T sum(const T* p, std::size_t n)
+{
+    return detail::dispatch<T>([&](auto k) { return k.sum(p, n); });
+}
+
+// Precondition: n > 0
+template <Element T>
+T min(const T* p, std::size_t n)
+{
+    assert(n > 0);
+    return detail::dispatch<T>([&](auto k) { return k.min(p, n); });
+}
+
+// Precondition: n > 0
+template <Element T>
+T max(const T* p, std::size_t n)
+{
+    assert(n > 0);
+    return detail::dispatch<T>([&](auto k) { return k.max(p, n); });
+}
+
+template <Element T>
+T dot(const T* a, const T* b, std::size_t n)
+{
+    return detail::dispatch<T>([&](auto k) { return k.dot(a, b, n); });
+}
+
+// Returns the index of the first element equal to value, or n.
+template <Element T>
+std::size_t find(const T* p, std::size_t n, T value)
+{
+    return detail::dispatch<T>([&](auto k) { return k.find(p, n, value); });
+}
+
+// y[i] += a * x[i]
+template <Element T>
+void scaled_add(T* y, const T* x, T a, std::size_t n)
+{
+    detail::dispatch<T>([&](auto k) { k.scaled_add(y, x, a, n); });
+}
+
+// Container overloads: anything exposing data() and size(), such as array
+// and Vector.
+template <typename Container>
+void fill(Container& c, detail::element_t<Container> value)
+{
+    fill(c.data(), c.size(), value);
+}
+
+template <typename Container>
+auto sum(Container& c)
+{
+    return sum<detail::element_t<Container>>(c.data(), c.size());
+}
+
+template <typename Container>
+auto min(Container& c)
+{
+    return min<detail::element_t<Container>>(c.data(), c.size());
+}
+
+template <typename Container>
+auto max(Container& c)
+{
+    return max<detail::element_t<Container>>(c.data(), c.size());
+}
+
+template <typename Container>
+auto dot(Container& a, Container& b)
+{
+    assert(a.size() == b.size());
+    return dot<detail::element_t<Container>>(a.data(), b.data(), a.size());
+}
+
+template <typename Container>
+std::size_t find(Container& c, detail::element_t<Container> value)
+{
+    return find(c.data(), c.size(), value);
+}
+
+template <typename Container>
+void scaled_add(
+    Container& y, const Container& x, detail::element_t<Container> a
+)
+{
+    assert(y.size() == x.size());
+    scaled_add(y.data(), x.data(), a, y.size());
+}
+
+}   // namespace simd
+
+#endif   // SIMD_CPP
+
+// Self-tests; files that include this one for the kernels define
+// SIMD_NO_MAIN first.
+#ifndef SIMD_NO_MAIN
+
+#define ARRAY_NO_MAIN
+#define VECTOR_NO_MAIN
+#include "array.cpp"
+#include "vector.cpp"
+
+template <typename T>
+bool run_kernel_tests(std::size_t offset)
+{
+    bool ok = true;
+
+    // Offset the start so heads and tails are exercised.
+    std::vector<T> storage(offset + 1003);
+    T*             p = storage.data() + offset;
+    std::size_t    n = 1003 - offset;
+
+    std::vector<T> other(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        p[i]     = static_cast<T>(i % 7 + 1);
+        other[i] = static_cast<T>(i % 3);
+    }
+    p[n / 2]     = static_cast<T>(100);
+    p[n / 2 + 1] = static_cast<T>(0);
+
+    using Scalar = simd::detail::ScalarIsa<T>;
+    ok &= simd::sum(p, n) == Scalar::sum(p, n);
+    ok &= simd::min(p, n) == static_cast<T>(0);
+    ok &= simd::max(p, n) == static_cast<T>(100);
+    ok &= simd::dot(p, other.data(), n) == Scalar::dot(p, other.data(), n);
+    ok &= simd::find(p, n, static_cast<T>(100)) == n / 2;
+    ok &= simd::find(p, n, static_cast<T>(42)) == n;
+
+    std::vector<T> expected(p, p + n);
+    Scalar::scaled_add(expected.data(), other.data(), static_cast<T>(2), n);
+    simd::scaled_add(p, other.data(), static_cast<T>(2), n);
+    for (std::size_t i = 0; i < n; ++i)
+        ok &= p[i] == expected[i];
+
+    simd::fill(p, n, static_cast<T>(5));
+    for (std::size_t i = 0; i < n; ++i)
+        ok &= p[i] == static_cast<T>(5);
+    ok &= storage[0] == T{} || offset == 0;
+
+    return ok;
+}
+
+int main()
+{
+    bool allTestsPassed = true;
+
+    std::cout << "Detected ISA: " << simd::isa_name(simd::active_isa())
+              << "\n";
+
+    simd::Isa best = simd::detect_isa();
+    for (auto isa :
+         { simd::Isa::Scalar, simd::Isa::SSE2, simd::Isa::AVX2,
+           simd::Isa::AVX512 })
+    {
+        if (isa > best)
+            break;
+        simd::set_isa(isa);
+
+        for (std::size_t offset : { 0, 1, 3 })
+        {
+            bool ok = run_kernel_tests<float>(offset) &&
+                      run_kernel_tests<double>(offset) &&
+                      run_kernel_tests<int>(offset) &&
+                      run_kernel_tests<std::int8_t>(offset) &&
+                      run_kernel_tests<std::uint64_t>(offset);
+            if (!ok)
+            {
+                allTestsPassed = false;
+                std::cerr << "TEST FAILED: kernels with " << simd::isa_name(isa)
+                          << " at offset " << offset << "\n";
+            }
+        }
+    }
+    simd::set_isa(best);
+
+    // Container overloads
+    {
+        std::array<int, 10> arr{};
+        simd::fill(arr, 3);
+        std::vector<int> vec(10, 2);
+        if (simd::sum(arr) != 30 || simd::dot(vec, vec) != 40 ||
+            simd::find(arr, 3) != 0)
+        {
+            allTestsPassed = false;
+            std::cerr << "TEST FAILED: container overloads\n";
+        }
+    }
+
+    // The repo's own containers, including array::fill
+    {
+        array<std::int8_t, 67> bytes;
+        array<float, 37, 64>   floats;
+        Vector<int>            ints;
+        Vector<double>         ones(101, 1.0);
+        Vector<double>         twos(101, 2.0);
+        for (int i = 0; i < 1000; ++i)
+            ints.push_back(i % 5);
+
+        bytes.fill(1);
+        floats.fill(1.5f);
+        simd::scaled_add(ones, twos, 0.5);
+
+        bool ok = simd::sum(bytes) == 67 && simd::sum(floats) == 55.5f &&
+                  simd::sum(ints) == 2000 && simd::find(ints, 4) == 4 &&
+                  simd::max(ints) == 4 && simd::dot(ones, twos) == 404.0;
+        simd::fill(ints, 7);
+        ok &= simd::min(ints) == 7 && simd::max(ints) == 7;
+        if (!ok)
+        {
+            allTestsPassed = false;
+            std::cerr << "TEST FAILED: array and Vector\n";
+        }
+    }
+
+    if (allTestsPassed)
+    {
+        std::cout << "All tests passed successfully!\n";
+    }
+    else
+    {
+        std::cout << "Some tests failed. Check error messages above.\n";
+    }
+
+    return 0;
+}
+
+#endif   // SIMD_NO_MAIN
@@ -0,0 +1,438 @@
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Structure-of-arrays counterpart to Vector: every field gets its own
+// contiguous column, and all columns grow together. Columns are allocated
+// through std::allocator_traits with Allocator rebound to each field type,
+// and exposed as spans so a scan over one field only touches that field's
+// memory. operator[] returns a tuple of references as a row view.
+template <class Allocator, class... Fields>
+class BasicSoAVector
+{
+    static_assert(sizeof...(Fields) > 0, "SoAVector needs at least one field");
+    static_assert(
+        (std::is_nothrow_move_constructible_v<Fields> && ...),
+        "Columns are relocated field by field and cannot roll back"
+    );
+
+public:
+    template <size_t I>
+    using field_t = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+private:
+    using Indices = std::index_sequence_for<Fields...>;
+
+    template <size_t I>
+    using ColumnAllocator = typename std::allocator_traits<
+        Allocator>::template rebind_alloc<field_t<I>>;
+
+    template <size_t I>
+    using ColumnTraits = std::allocator_traits<ColumnAllocator<I>>;
+
+    size_t                 m_size{};
+    size_t                 m_capacity{};
+    std::tuple<Fields*...> m_columns{};
+    Allocator              m_allocator{};
+
+    template <size_t I>
+    void destroy_column()
+    {
+        ColumnAllocator<I> allocator{ m_allocator };
+        field_t<I>*        column = std::get<I>(m_columns);
+        for (size_t i{ 0 }; i < m_size; ++i)
+            ColumnTraits<I>::destroy(allocator, column + i);
+    }
+
+    template <size_t I>
+    field_t<I>* allocate_column(size_t capacity)
+    {
+        ColumnAllocator<I> allocator{ m_allocator };
+        return ColumnTraits<I>::allocate(allocator, capacity);
+    }
+
+    template <size_t I>
+    void deallocate_column(field_t<I>* column, size_t capacity)
+    {
+        ColumnAllocator<I> allocator{ m_allocator };
+        if (column)
+            ColumnTraits<I>::deallocate(allocator, column, capacity);
+    }
+
+    // Moves column I into newColumn and releases the old buffer.
+    template <size_t I>
+    void relocate_column(field_t<I>* newColumn)
+    {
+        using F = field_t<I>;
+
+        F*                 old = std::get<I>(m_columns);
+        ColumnAllocator<I> allocator{ m_allocator };
+
+        if constexpr (std::is_trivially_copyable_v<F>)
+        {
+            if (m_size != 0)
+                std::memcpy(newColumn, old, m_size * sizeof(F));
+        }
+        else
+        {
+            for (size_t i{ 0 }; i < m_size; ++i)
+            {
+                ColumnTraits<I>::construct(
+                    allocator, newColumn + i, std::move(old[i])
+                );
+                ColumnTraits<I>::destroy(allocator, old + i);
+            }
+        }
+
+        deallocate_column<I>(old, m_capacity);
+        std::get<I>(m_columns) = newColumn;
+    }
+
+    template <size_t... I>
+    void reallocate(size_t capacity, std::index_sequence<I...>)
+    {
+        // Allocate every column first so a failure leaves us untouched.
+        std::tuple<Fields*...> fresh{};
+        try
+        {
+            ((std::get<I>(fresh) = allocate_column<I>(capacity)), ...);
+        }
+        catch (...)
+        {
+            (deallocate_column<I>(std::get<I>(fresh), capacity), ...);
+            throw;
+        }
+
+        (relocate_column<I>(std::get<I>(fresh)), ...);
+        m_capacity = capacity;
+    }
+
+    template <size_t... I>
+    void release(std::index_sequence<I...>)
+    {
+        (destroy_column<I>(), ...);
+        (deallocate_column<I>(std::get<I>(m_columns), m_capacity), ...);
+    }
+
+    template <size_t I, class Arg>
+    void construct_field(Arg&& arg)
+    {
+        ColumnAllocator<I> allocator{ m_allocator };
+        ColumnTraits<I>::construct(
+            allocator, std::get<I>(m_columns) + m_size, std::forward<Arg>(arg)
+        );
+    }
+
+    template <size_t I>
+    void destroy_field()
+    {
+        ColumnAllocator<I> allocator{ m_allocator };
+        ColumnTraits<I>::destroy(allocator, std::get<I>(m_columns) + m_size);
+    }
+
+    // Builds the fields of row m_size left to right; if one throws, the
+    // fields already built are destroyed before rethrowing.
+    template <size_t... I, class... Args>
+    void construct_row(std::index_sequence<I...>, Args&&... args)
+    {
+        size_t built = 0;
+        try
+        {
+            ((construct_field<I>(std::forward<Args>(args)), ++built), ...);
+        }
+        catch (...)
+        {
+            ((I < built ? destroy_field<I>() : void()), ...);
+            throw;
+        }
+    }
+
+    template <size_t... I>
+    void move_row_from(
+        BasicSoAVector& other, size_t index, std::index_sequence<I...>
+    )
+    {
+        construct_row(
+            Indices{}, std::move(std::get<I>(other.m_columns)[index])...
+        );
+        ++m_size;
+    }
+
+    void release_storage()
+    {
+        release(Indices{});
+        m_size     = 0;
+        m_capacity = 0;
+        m_columns  = {};
+    }
+
+    void steal(BasicSoAVector& other) noexcept
+    {
+        m_size     = std::exchange(other.m_size, 0);
+        m_capacity = std::exchange(other.m_capacity, 0);
+        m_columns  = std::exchange(other.m_columns, {});
+    }
+
+    template <size_t... I>
+    std::tuple<Fields&...> row(size_t index, std::index_sequence<I...>)
+    {
+        return { std::get<I>(m_columns)[index]... };
+    }
+
+public:
+    BasicSoAVector() = default;
+    explicit BasicSoAVector(const Allocator& allocator)
+        : m_allocator{ allocator }
+    {}
+    BasicSoAVector(const BasicSoAVector&)            = delete;
+    BasicSoAVector& operator=(const BasicSoAVector&) = delete;
+    BasicSoAVector(BasicSoAVector&& other) noexcept
+        : m_size{ std::exchange(other.m_size, 0) },
+          m_capacity{ std::exchange(other.m_capacity, 0) },
+          m_columns{ std::exchange(other.m_columns, {}) },
+          m_allocator{ std::move(other.m_allocator) }
+    {}
+    // Follows Vector: the columns are taken over when the allocator
+    // propagates or compares equal; otherwise the rows are moved one by
+    // one into storage from this vector's own allocator.
+    BasicSoAVector& operator=(BasicSoAVector&& other) noexcept(
+        std::allocator_traits<
+            Allocator>::propagate_on_container_move_assignment::value ||
+        std::allocator_traits<Allocator>::is_always_equal::value
+    )
+    {
+        using Traits = std::allocator_traits<Allocator>;
+        if (this == &other)
+            return *this;
+
+        if constexpr (Traits::propagate_on_container_move_assignment::value)
+        {
+            release_storage();
+            m_allocator = std::move(other.m_allocator);
+            steal(other);
+        }
+        else
+        {
+            if (m_allocator == other.m_allocator)
+            {
+                release_storage();
+                steal(other);
+            }
+            else
+            {
+                clear();
+                reserve(other.m_size);
+                for (size_t i{ 0 }; i < other.m_size; ++i)
+                    move_row_from(other, i, Indices{});
+                other.clear();
+            }
+        }
+        return *this;
+    }
+    ~BasicSoAVector() { release(Indices{}); }
+
+    void reserve(size_t capacity)
+    {
+        if (capacity > m_capacity)
+            reallocate(capacity, Indices{});
+    }
+
+    // Takes one argument per field. If a field constructor throws, the
+    // row is rolled back and the vector is left unchanged apart from a
+    // possibly larger capacity.
+    template <class... Args>
+        requires(sizeof...(Args) == sizeof...(Fields))
+    void emplace_back(Args&&... args)
+    {
+        if (m_size == m_capacity)
+            reserve(m_capacity == 0 ? 1 : m_capacity * 2);
+
+        construct_row(Indices{}, std::forward<Args>(args)...);
+        ++m_size;
+    }
+
+    void push_back(const Fields&... values) { emplace_back(values...); }
+
+    void clear()
+    {
+        [this]<size_t... I>(std::index_sequence<I...>)
+        {
+            (destroy_column<I>(), ...);
+        }(Indices{});
+        m_size = 0;
+    }
+
+    size_t    size() const { return m_size; }
+    size_t    capacity() const { return m_capacity; }
+    bool      empty() const { return m_size == 0; }
+    Allocator get_allocator() const { return m_allocator; }
+
+    template <size_t I>
+    std::span<field_t<I>> column()
+    {
+        return { std::get<I>(m_columns), m_size };
+    }
+
+    template <size_t I>
+    std::span<const field_t<I>> column() const
+    {
+        return { std::get<I>(m_columns), m_size };
+    }
+
+    std::tuple<Fields&...> operator[](size_t index)
+    {
+        assert(index < m_size);
+        return row(index, Indices{});
+    }
+};
+
+template <class... Fields>
+using SoAVector = BasicSoAVector<std::allocator<std::byte>, Fields...>;
+
+// Compares equal only to copies with the same id and never propagates, so
+// move assignment between two ids has to move row by row.
+template <class T>
+struct IdAllocator
+{
+    using value_type = T;
+
+    int id{ 0 };
+
+    IdAllocator() = default;
+    explicit IdAllocator(int id)
+        : id{ id }
+    {}
+    template <class U>
+    IdAllocator(const IdAllocator<U>& other)
+        : id{ other.id }
+    {}
+
+    T* allocate(size_t n) { return std::allocator<T>{}.allocate(n); }
+    void deallocate(T* ptr, size_t n)
+    {
+        std::allocator<T>{}.deallocate(ptr, n);
+    }
+
+    friend bool operator==(const IdAllocator&, const IdAllocator&) = default;
+};
+
+int main()
+{
+    // Columns are filled row by row and read back as spans
+    {
+        SoAVector<int, double, char> v;
+        for (int i = 0; i < 100; ++i)
+            v.push_back(i, i * 0.5, static_cast<char>('a' + i % 26));
+
+        assert(v.size() == 100);
+        assert(v.capacity() >= 100);
+
+        auto ids = v.column<0>();
+        assert(ids.size() == 100);
+        long sum = 0;
+        for (int id : ids)
+            sum += id;
+        assert(sum == 4950);
+
+        assert(v.column<1>()[10] == 5.0);
+        assert(v.column<2>()[27] == 'b');
+    }
+
+    // Row view gives references into every column
+    {
+        SoAVector<int, std::string> v;
+        v.emplace_back(1, "one");
+        v.emplace_back(2, "two");
+
+        auto [id, name] = v[1];
+        assert(id == 2 && name == "two");
+        id   = 20;
+        name = "twenty";
+        assert(v.column<0>()[1] == 20);
+        assert(v.column<1>()[1] == "twenty");
+
+        for (int i = 0; i < 50; ++i)
+            v.emplace_back(i, std::to_string(i));
+        assert(v.column<1>()[0] == "one" && v.column<1>()[51] == "49");
+
+        SoAVector<int, std::string> moved(std::move(v));
+        assert(moved.size() == 52 && v.size() == 0);
+
+        moved.clear();
+        assert(moved.empty());
+        moved.emplace_back(3, "three");
+        assert(std::get<1>(moved[0]) == "three");
+    }
+
+    // A throwing field rolls back the fields already built for the row
+    {
+        static int live = 0;
+        struct Counted
+        {
+            Counted(int) { ++live; }
+            Counted(Counted&&) noexcept { ++live; }
+            ~Counted() { --live; }
+        };
+        struct Throwing
+        {
+            Throwing(bool fail)
+            {
+                if (fail)
+                    throw std::runtime_error{ "field" };
+            }
+        };
+
+        {
+            SoAVector<Counted, Throwing> v;
+            v.emplace_back(1, false);
+            bool threw = false;
+            try
+            {
+                v.emplace_back(2, true);
+            }
+            catch (const std::runtime_error&)
+            {
+                threw = true;
+            }
+            assert(threw && v.size() == 1 && live == 1);
+
+            v.emplace_back(3, false);
+            assert(v.size() == 2 && live == 2);
+        }
+        assert(live == 0);
+    }
+
+    // Move assignment honours propagate_on_container_move_assignment
+    {
+        using Rows = BasicSoAVector<IdAllocator<std::byte>, int, std::string>;
+
+        Rows source{ IdAllocator<std::byte>{ 1 } };
+        for (int i = 0; i < 20; ++i)
+            source.emplace_back(i, std::to_string(i));
+
+        Rows target{ IdAllocator<std::byte>{ 2 } };
+        target.emplace_back(-1, "old");
+        const int* sourceIds = source.column<0>().data();
+        target               = std::move(source);
+        assert(target.get_allocator().id == 2);
+        assert(target.size() == 20 && source.size() == 0);
+        assert(target.column<0>().data() != sourceIds);
+        assert(target.column<1>()[19] == "19");
+
+        Rows same{ IdAllocator<std::byte>{ 2 } };
+        const int* targetIds = target.column<0>().data();
+        same                 = std::move(target);
+        assert(same.column<0>().data() == targetIds && same.size() == 20);
+    }
+
+    std::cout << "All tests passed.\n";
+    return 0;
+}
@@ -1,4 +1,10 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <new>
+#include <thread>
+#include <type_traits>
 #include <utility>
 
 template <typename T>
@@ -7,12 +13,21 @@ struct DefaultDeleter
     void operator()(T* ptr) const { delete ptr; }
 };
 
+template <typename T>
+struct DefaultDeleter<T[]>
+{
+    void operator()(T* ptr) const { delete[] ptr; }
+};
+
+// Sole owner of an object. An empty Deleter takes no space, so with the
+// default one the pointer is exactly the size of T*. The deleter is never
+// called with null.
 template <class T, class Deleter = DefaultDeleter<T>>
 class UniquePointer
 {
 private:
-    T*      m_ptr{ nullptr };
-    Deleter m_deleter{};
+    T*                            m_ptr{ nullptr };
+    [[no_unique_address]] Deleter m_deleter{};
 
 public:
     UniquePointer() {};
@@ -34,7 +49,11 @@ public:
         return *this;
     }
 
-    ~UniquePointer() { m_deleter(m_ptr); }
+    ~UniquePointer()
+    {
+        if (m_ptr)
+            m_deleter(m_ptr);
+    }
 
     T* release() noexcept
     {
@@ -43,10 +62,10 @@ public:
         return temp;
     }
 
-    void reset(T* ptr) noexcept
+    void reset(T* ptr = nullptr) noexcept
     {
-        m_deleter(m_ptr);
-        m_ptr = ptr;
+        if (T* old = std::exchange(m_ptr, ptr))
+            m_deleter(old);
     }
 
     void swap(UniquePointer& other) noexcept
@@ -62,6 +81,399 @@ public:
     Deleter  get_deleter() const { return m_deleter; }
 };
 
+// Owner of an array allocated with new[]; indexes instead of dereferencing.
+template <class T, class Deleter>
+class UniquePointer<T[], Deleter>
+{
+private:
+    T*                            m_ptr{ nullptr };
+    [[no_unique_address]] Deleter m_deleter{};
+
+public:
+    UniquePointer() {};
+    explicit UniquePointer(T* ptr)
+        : m_ptr{ ptr } {};
+    UniquePointer(const UniquePointer&)            = delete;
+    UniquePointer& operator=(const UniquePointer&) = delete;
+    UniquePointer(UniquePointer&& other) noexcept
+        : m_ptr{ std::exchange(other.m_ptr, nullptr) },
+          m_deleter{ std::exchange(other.m_deleter, Deleter{}) } {};
+
+    UniquePointer& operator=(UniquePointer&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset(other.release());
+            m_deleter = std::move(other.m_deleter);
+        }
+        return *this;
+    }
+
+    ~UniquePointer()
+    {
+        if (m_ptr)
+            m_deleter(m_ptr);
+    }
+
+    T* release() noexcept { return std::exchange(m_ptr, nullptr); }
+
+    void reset(T* ptr = nullptr) noexcept
+    {
+        if (T* old = std::exchange(m_ptr, ptr))
+            m_deleter(old);
+    }
+
+    void swap(UniquePointer& other) noexcept
+    {
+        std::swap(m_ptr, other.m_ptr);
+        std::swap(m_deleter, other.m_deleter);
+    }
+
+    T&       operator[](size_t index) const { return m_ptr[index]; }
+    T*       get() const { return m_ptr; }
+    explicit operator bool() const noexcept { return m_ptr != nullptr; }
+    Deleter  get_deleter() const { return m_deleter; }
+};
+
+// Allocates with default-initialization, so trivial types (and arrays of
+// them) are left uninitialized for buffers about to be overwritten anyway.
+template <class T>
+    requires(!std::is_array_v<T>)
+UniquePointer<T> make_unique_for_overwrite()
+{
+    return UniquePointer<T>{ new T };
+}
+
+template <class T>
+    requires std::is_unbounded_array_v<T>
+UniquePointer<T> make_unique_for_overwrite(size_t count)
+{
+    return UniquePointer<T>{ new std::remove_extent_t<T>[count] };
+}
+
+static_assert(sizeof(UniquePointer<int>) == sizeof(int*));
+static_assert(sizeof(UniquePointer<int[]>) == sizeof(int*));
+
+// Base for objects that carry their own reference count, for small and
+// numerous objects where SharedPointer's separate control block would
+// double the memory and the pointer chasing. Derive as
+// struct Node : RefCounted<Node> {}; pass Atomic = false for objects that
+// never cross threads, which turns the count into a plain integer.
+//
+// IntrusivePointer finds the count through the intrusive_add_ref and
+// intrusive_release hooks by argument-dependent lookup; a type that keeps
+// its count some other way can provide the two functions itself.
+template <class Derived, bool Atomic = true>
+class RefCounted
+{
+private:
+    using Count = std::conditional_t<Atomic, std::atomic<uint32_t>, uint32_t>;
+
+    mutable Count m_refs{ 0 };
+
+protected:
+    RefCounted() = default;
+    // A copy is a new object with owners of its own.
+    RefCounted(const RefCounted&) noexcept {}
+    RefCounted& operator=(const RefCounted&) noexcept { return *this; }
+    ~RefCounted() = default;
+
+public:
+    uint32_t use_count() const noexcept
+    {
+        if constexpr (Atomic)
+            return m_refs.load(std::memory_order_relaxed);
+        else
+            return m_refs;
+    }
+
+    friend void intrusive_add_ref(const Derived* ptr) noexcept
+    {
+        if constexpr (Atomic)
+            ptr->m_refs.fetch_add(1, std::memory_order_relaxed);
+        else
+            ++ptr->m_refs;
+    }
+
+    friend void intrusive_release(const Derived* ptr) noexcept
+    {
+        bool last;
+        if constexpr (Atomic)
+            last = ptr->m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1;
+        else
+            last = --ptr->m_refs == 0;
+
+        if (last)
+            delete ptr;
+    }
+};
+
+// Shared owner of an object that counts its own references; the same size
+// as a raw pointer. Any raw pointer to a live object can be wrapped again,
+// and a UniquePointer can hand its object over to shared ownership.
+template <class T>
+class IntrusivePointer
+{
+private:
+    T* m_ptr{ nullptr };
+
+public:
+    IntrusivePointer() = default;
+    IntrusivePointer(std::nullptr_t) {}
+    explicit IntrusivePointer(T* ptr)
+        : m_ptr{ ptr }
+    {
+        if (m_ptr)
+            intrusive_add_ref(m_ptr);
+    }
+
+    // Promotes a unique owner to a shared one. Only the default deleter is
+    // accepted, since the last release deletes the object.
+    IntrusivePointer(UniquePointer<T>&& owner)
+        : IntrusivePointer(owner.release())
+    {}
+
+    IntrusivePointer(const IntrusivePointer& other)
+        : IntrusivePointer(other.m_ptr)
+    {}
+    IntrusivePointer(IntrusivePointer&& other) noexcept
+        : m_ptr{ std::exchange(other.m_ptr, nullptr) }
+    {}
+    IntrusivePointer& operator=(const IntrusivePointer& other)
+    {
+        IntrusivePointer{ other }.swap(*this);
+        return *this;
+    }
+    IntrusivePointer& operator=(IntrusivePointer&& other) noexcept
+    {
+        IntrusivePointer{ std::move(other) }.swap(*this);
+        return *this;
+    }
+    ~IntrusivePointer()
+    {
+        if (m_ptr)
+            intrusive_release(m_ptr);
+    }
+
+    void reset() noexcept { IntrusivePointer{}.swap(*this); }
+    void reset(T* ptr) { IntrusivePointer{ ptr }.swap(*this); }
+
+    void swap(IntrusivePointer& other) noexcept
+    {
+        std::swap(m_ptr, other.m_ptr);
+    }
+
+    T*       operator->() const { return m_ptr; }
+    T&       operator*() const { return *m_ptr; }
+    T*       get() const { return m_ptr; }
+    explicit operator bool() const noexcept { return m_ptr != nullptr; }
+};
+
+// Per-thread free list of storage for T objects. Objects released on a
+// thread go to that thread's list (up to max_cached), so steady churn of
+// same-typed objects stops reaching operator new and delete altogether.
+//
+// Each block starts with a header naming the pool that allocated it. An
+// object freed on another thread is pushed onto its owner's lock-free
+// remote list, which the owner drains when its own list runs dry. The
+// pool lives on the heap: when its thread exits it frees what it has
+// cached and stays alive until every block still out has come back, and
+// blocks that come back after that go straight to operator delete.
+template <class T>
+class ObjectPool
+{
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+private:
+    struct Node
+    {
+        Node* next;
+    };
+
+    struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) Header
+    {
+        ObjectPool* owner;
+    };
+
+    static constexpr size_t payload_bytes =
+        sizeof(T) > sizeof(Node) ? sizeof(T) : sizeof(Node);
+    static constexpr size_t block_bytes = sizeof(Header) + payload_bytes;
+    static constexpr size_t max_cached = 1024;
+
+    // Closes this thread's pool when the thread exits.
+    struct Closer
+    {
+        ~Closer()
+        {
+            if (t_local)
+                std::exchange(t_local, nullptr)->close();
+        }
+    };
+
+    // A raw pointer stays readable while thread_locals are being destroyed,
+    // so objects freed that late still find out their pool is gone.
+    static inline thread_local ObjectPool* t_local{ nullptr };
+
+    Node*  m_head{ nullptr };
+    size_t m_cached{ 0 };
+    size_t m_live{ 0 };   // Blocks handed out and not yet back
+    size_t m_hits{ 0 };
+    size_t m_misses{ 0 };
+
+    std::atomic<Node*>     m_remote{ nullptr };   // Freed on other threads
+    std::atomic<ptrdiff_t> m_orphans{ 0 };        // Blocks out once closed
+
+    ObjectPool() = default;
+
+    // Marks m_remote once the owning thread has exited; never a real node.
+    static Node* closed() { return reinterpret_cast<Node*>(alignof(Node)); }
+
+    static Header* header_of(void* ptr)
+    {
+        return static_cast<Header*>(ptr) - 1;
+    }
+
+    void push_local(Node* node) noexcept
+    {
+        --m_live;
+        if (m_cached == max_cached)
+            return ::operator delete(header_of(node));
+
+        node->next = m_head;
+        m_head     = node;
+        ++m_cached;
+    }
+
+    // Called from other threads; after close() the block is freed instead.
+    void push_remote(Node* node) noexcept
+    {
+        Node* head = m_remote.load(std::memory_order_relaxed);
+        do
+        {
+            if (head == closed())
+            {
+                ::operator delete(header_of(node));
+                if (m_orphans.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    delete this;
+                return;
+            }
+            node->next = head;
+        } while (!m_remote.compare_exchange_weak(
+            head, node, std::memory_order_release, std::memory_order_relaxed
+        ));
+    }
+
+    // Moves everything other threads have freed onto the local list.
+    void drain_remote() noexcept
+    {
+        Node* list = m_remote.exchange(nullptr, std::memory_order_acquire);
+        while (list)
+        {
+            Node* next = list->next;
+            push_local(list);
+            list = next;
+        }
+    }
+
+    // Runs at thread exit. Blocks still out keep the pool alive, and the
+    // last of them to come back deletes it.
+    void close() noexcept
+    {
+        Node* list = m_remote.exchange(closed(), std::memory_order_acquire);
+        for (; list; --m_live)
+            ::operator delete(header_of(std::exchange(list, list->next)));
+        for (; m_head; --m_cached)
+            ::operator delete(header_of(std::exchange(m_head, m_head->next)));
+
+        auto live = static_cast<ptrdiff_t>(m_live);
+        if (m_orphans.fetch_add(live, std::memory_order_acq_rel) + live == 0)
+            delete this;
+    }
+
+public:
+    ObjectPool(const ObjectPool&)            = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    static ObjectPool& local()
+    {
+        if (!t_local)
+        {
+            thread_local Closer closer;
+            t_local = new ObjectPool;
+        }
+        return *t_local;
+    }
+
+    // Raw storage for one T; construct it with placement new.
+    void* allocate()
+    {
+        if (!m_head && m_remote.load(std::memory_order_relaxed))
+            drain_remote();
+
+        ++m_live;
+        if (!m_head)
+        {
+            ++m_misses;
+            Header* header = static_cast<Header*>(::operator new(block_bytes));
+            header->owner  = this;
+            return header + 1;
+        }
+
+        ++m_hits;
+        --m_cached;
+        return std::exchange(m_head, m_head->next);
+    }
+
+    // Returns storage from allocate() on any pool, from any thread.
+    static void deallocate(void* ptr) noexcept
+    {
+        ObjectPool* owner = header_of(ptr)->owner;
+        Node*       node  = new (ptr) Node{ nullptr };
+        if (owner == t_local)
+            owner->push_local(node);
+        else
+            owner->push_remote(node);
+    }
+
+    // Allocations served from the free list and from operator new.
+    size_t hits() const { return m_hits; }
+    size_t misses() const { return m_misses; }
+    size_t cached() const { return m_cached; }
+};
+
+// Destroys the object and hands its storage back to the pool it came from.
+template <class T>
+struct PoolDeleter
+{
+    void operator()(T* ptr) const noexcept
+    {
+        if (ptr)
+        {
+            ptr->~T();
+            ObjectPool<T>::deallocate(ptr);
+        }
+    }
+};
+
+template <class T>
+using PooledPointer = UniquePointer<T, PoolDeleter<T>>;
+
+// Like new T(args...), but reusing storage from the thread's ObjectPool.
+template <class T, class... Args>
+PooledPointer<T> make_pooled(Args&&... args)
+{
+    void* storage = ObjectPool<T>::local().allocate();
+    try
+    {
+        return PooledPointer<T>{ new (storage) T(std::forward<Args>(args)...) };
+    }
+    catch (...)
+    {
+        ObjectPool<T>::deallocate(storage);
+        throw;
+    }
+}
+
 struct Test
 {
     int value;
@@ -152,6 +564,120 @@ int main()
                   << "\n";   // Expect: 900, 800
     }   // Both pointers go out of scope, should delete Test(800) and Test(900)
 
+    std::cout << "----------------------\n";
+
+    // Test 7: IntrusivePointer keeps the count inside the object
+    {
+        struct Node : RefCounted<Node>
+        {
+            Test                   payload;
+            IntrusivePointer<Node> next;
+            Node(int v)
+                : payload(v)
+            {}
+        };
+        static_assert(sizeof(IntrusivePointer<Node>) == sizeof(Node*));
+
+        IntrusivePointer<Node> head(new Node(1000));
+        head->next.reset(new Node(1001));
+        IntrusivePointer<Node> second = head->next;
+        std::cout << "Second node owners: " << second->use_count()
+                  << "\n";   // Expect: 2
+
+        IntrusivePointer<Node> again(second.get());
+        std::cout << "Owners after rewrapping: " << second->use_count()
+                  << "\n";   // Expect: 3
+    }   // Releasing head destroys Test(1001) first, then Test(1000)
+
+    std::cout << "----------------------\n";
+
+    // Test 8: Promoting a UniquePointer to shared ownership
+    {
+        struct LocalNode : RefCounted<LocalNode, false>
+        {
+            Test payload;
+            LocalNode(int v)
+                : payload(v)
+            {}
+        };
+
+        UniquePointer<LocalNode>    unique(new LocalNode(1100));
+        IntrusivePointer<LocalNode> shared(std::move(unique));
+        IntrusivePointer<LocalNode> copy = shared;
+        std::cout << "Unique is now " << (unique ? "not null" : "null")
+                  << ", owners: " << shared->use_count()
+                  << "\n";   // Expect: null, 2
+    }   // Both owners go out of scope, should delete Test(1100) once
+
+    std::cout << "----------------------\n";
+
+    // Test 9: Pooled objects recycle their storage
+    {
+        static_assert(std::is_empty_v<PoolDeleter<Test>>);
+        static_assert(sizeof(PooledPointer<Test>) == sizeof(Test*));
+
+        ObjectPool<Test>& pool  = ObjectPool<Test>::local();
+        Test*             first = nullptr;
+        {
+            PooledPointer<Test> ptr = make_pooled<Test>(1200);
+            first                   = ptr.get();
+        }   // Test(1200) destroyed, storage kept in the pool
+
+        PooledPointer<Test> ptr = make_pooled<Test>(1201);
+        std::cout << "Storage reused: " << (ptr.get() == first ? "yes" : "no")
+                  << ", hits: " << pool.hits() << ", misses: " << pool.misses()
+                  << "\n";   // Expect: yes, 1, 1
+
+        // Freed on another thread, the storage still returns to this pool
+        Test* second = ptr.get();
+        std::thread{ [&ptr] { ptr.reset(); } }.join();   // Destroys Test(1201)
+        ptr = make_pooled<Test>(1202);
+        std::cout << "Storage returned across threads: "
+                  << (ptr.get() == second ? "yes" : "no")
+                  << "\n";   // Expect: yes
+
+        // An object may outlive the thread, and the pool, that made it
+        PooledPointer<Test> orphan;
+        std::thread{ [&orphan] { orphan = make_pooled<Test>(1203); } }.join();
+        orphan.reset();   // Destroys Test(1203) and frees the closed pool
+    }   // ptr goes out of scope, should destroy Test(1202)
+
+    std::cout << "----------------------\n";
+
+    // Test 10: Array specialization and make_unique_for_overwrite
+    {
+        UniquePointer<int[]> numbers = make_unique_for_overwrite<int[]>(4);
+        for (int i = 0; i < 4; ++i)
+            numbers[i] = i * i;
+        std::cout << "numbers[3]: " << numbers[3] << "\n";   // Expect: 9
+
+        UniquePointer<Test[]> tests(new Test[2]{ 1300, 1301 });
+        std::cout << "tests[1]: " << tests[1].value << "\n";   // Expect: 1301
+    }   // tests goes out of scope, should delete Test(1301) and Test(1300)
+
+    std::cout << "----------------------\n";
+
+    // Test 11: The deleter is never called with null
+    {
+        static int calls = 0;
+        struct CountingDeleter
+        {
+            void operator()(Test* ptr) const
+            {
+                ++calls;
+                delete ptr;
+            }
+        };
+
+        {
+            UniquePointer<Test, CountingDeleter> empty;
+            empty.reset();
+            empty.reset(new Test(1400));
+            empty.reset();   // Expect: Test(1400) destroyed
+        }
+        std::cout << "Deleter calls: " << calls << "\n";   // Expect: 1
+    }
+
     std::cout << "All tests completed.\n";
     return 0;
 }
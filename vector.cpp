@@ -1,9 +1,427 @@
+#ifndef VECTOR_CPP
+#define VECTOR_CPP
+
+#include <algorithm>
+#include <bit>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <initializer_list>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <new>
+#include <sys/mman.h>
+#include <span>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// Types whose objects can be moved to a new address with memcpy, leaving
+// nothing to destroy behind. Specialize for types that are not trivially
+// copyable but still relocatable (e.g. ones holding an owning pointer).
+template <class T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T>
+{};
+
+template <class T>
+inline constexpr bool is_trivially_relocatable_v =
+    is_trivially_relocatable<T>::value;
+
+// Tag selecting default-initialization (no zeroing for trivial types).
+struct default_init_t
+{
+    explicit default_init_t() = default;
+};
+inline constexpr default_init_t default_init{};
+
+// Growth policies: next_capacity returns the capacity to reserve once
+// `required` elements no longer fit in `current`.
+template <size_t Num, size_t Den = 1>
+struct GeometricGrowth
+{
+    static_assert(Num > Den, "Growth factor must be greater than one");
+
+    static size_t next_capacity(size_t current, size_t required, size_t)
+    {
+        size_t grown = current * Num / Den;
+        if (grown <= current)
+            grown = current + 1;
+        return std::max(grown, required);
+    }
+};
+
+using DoublingGrowth = GeometricGrowth<2>;
+
+// A factor below the golden ratio lets a later buffer fit into the space
+// released by the buffers before it.
+using OneAndHalfGrowth = GeometricGrowth<3, 2>;
+
+// Grows like Small until a buffer reaches ChunkBytes, then in whole chunks,
+// so large vectors waste at most one chunk instead of up to half their
+// size.
+template <size_t ChunkBytes = size_t{ 64 } << 20, class Small = DoublingGrowth>
+struct ChunkedGrowth
+{
+    static size_t
+        next_capacity(size_t current, size_t required, size_t elementSize)
+    {
+        size_t chunk = std::max<size_t>(ChunkBytes / elementSize, 1);
+        if (current < chunk)
+            return std::min(
+                Small::next_capacity(current, required, elementSize),
+                std::max(chunk, required)
+            );
+
+        size_t grown = current + chunk;
+        if (required > grown)
+            grown = (required + chunk - 1) / chunk * chunk;
+        return grown;
+    }
+};
+
+// Backs allocations of at least Threshold bytes with huge pages: explicit
+// MAP_HUGETLB pages when the system has some reserved, otherwise a huge
+// page aligned mapping advised for transparent huge pages. Smaller
+// requests go through std::allocator.
+template <class T, size_t Threshold = size_t{ 2 } << 20>
+struct HugePageAllocator
+{
+    using value_type = T;
+
+    static constexpr size_t huge_page_size = size_t{ 2 } << 20;
+
+    template <class U>
+    struct rebind
+    {
+        using other = HugePageAllocator<U, Threshold>;
+    };
+
+    HugePageAllocator() = default;
+    template <class U>
+    HugePageAllocator(const HugePageAllocator<U, Threshold>&)
+    {}
+
+    static size_t byte_count(size_t n)
+    {
+        if (n > SIZE_MAX / sizeof(T))
+            throw std::bad_array_new_length{};
+        return n * sizeof(T);
+    }
+
+    // Rounded up to whole huge pages, with room left for the extra page
+    // allocate() may map on top.
+    static size_t mapping_length(size_t n)
+    {
+        size_t bytes = byte_count(n);
+        if (bytes > SIZE_MAX - 2 * huge_page_size)
+            throw std::bad_array_new_length{};
+        return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+    }
+
+    T* allocate(size_t n)
+    {
+        if (byte_count(n) < Threshold)
+            return std::allocator<T>{}.allocate(n);
+
+        size_t length = mapping_length(n);
+        void*  ptr    = MAP_FAILED;
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+        // Without a size flag the kernel picks its default huge page size,
+        // which need not be huge_page_size; munmap relies on the two
+        // agreeing.
+        constexpr int page_size_flag = std::countr_zero(huge_page_size)
+                                    << MAP_HUGE_SHIFT;
+        ptr = mmap(
+            nullptr, length, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | page_size_flag, -1, 0
+        );
+#endif
+        if (ptr != MAP_FAILED)
+            return static_cast<T*>(ptr);
+
+        // Over-map by one huge page and trim so the block is aligned and
+        // the kernel can back it with transparent huge pages.
+        size_t padded = length + huge_page_size;
+        void*  raw    = mmap(
+            nullptr, padded, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+        );
+        if (raw == MAP_FAILED)
+            throw std::bad_alloc{};
+
+        auto   start   = reinterpret_cast<std::uintptr_t>(raw);
+        auto   aligned = (start + huge_page_size - 1) & ~(huge_page_size - 1);
+        size_t head    = aligned - start;
+        if (head != 0)
+            munmap(raw, head);
+        munmap(
+            reinterpret_cast<void*>(aligned + length), huge_page_size - head
+        );
+
+        ptr = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+        madvise(ptr, length, MADV_HUGEPAGE);
+#endif
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, size_t n)
+    {
+        if (n * sizeof(T) < Threshold)
+            return std::allocator<T>{}.deallocate(ptr, n);
+
+        munmap(ptr, mapping_length(n));
+    }
+
+    friend bool operator==(const HugePageAllocator&, const HugePageAllocator&)
+    {
+        return true;
+    }
+};
+
+// Monotonic arena: memory is handed out by bumping a pointer through a
+// list of chunks and is only returned all at once, by release() or the
+// destructor. Freeing the most recent block rolls the pointer back, so a
+// temporary that is freed before anything else is allocated costs no
+// space. A growing Vector does not benefit: it allocates its new buffer
+// before freeing the old one, so the old one is never on top.
+class Arena
+{
+private:
+    struct Chunk
+    {
+        Chunk* next;
+    };
+
+    Chunk* m_chunks{ nullptr };
+    char*  m_cursor{ nullptr };
+    char*  m_end{ nullptr };
+    size_t m_nextChunkSize;
+
+    void add_chunk(size_t minBytes)
+    {
+        size_t size  = std::max(m_nextChunkSize, minBytes + sizeof(Chunk));
+        auto*  chunk = static_cast<Chunk*>(::operator new(size));
+
+        chunk->next     = m_chunks;
+        m_chunks        = chunk;
+        m_cursor        = reinterpret_cast<char*>(chunk + 1);
+        m_end           = reinterpret_cast<char*>(chunk) + size;
+        m_nextChunkSize = size * 2;
+    }
+
+public:
+    explicit Arena(size_t initialChunkSize = 4096)
+        : m_nextChunkSize{ initialChunkSize }
+    {}
+    Arena(const Arena&)            = delete;
+    Arena& operator=(const Arena&) = delete;
+    ~Arena() { release(); }
+
+    void* allocate(size_t bytes, size_t alignment)
+    {
+        auto align = [&]
+        {
+            auto cursor = reinterpret_cast<std::uintptr_t>(m_cursor);
+            return (cursor + alignment - 1) & ~(alignment - 1);
+        };
+
+        std::uintptr_t start = align();
+        std::uintptr_t end   = reinterpret_cast<std::uintptr_t>(m_end);
+        if (!m_cursor || start + bytes > end)
+        {
+            add_chunk(bytes + alignment);
+            start = align();
+        }
+
+        m_cursor = reinterpret_cast<char*>(start + bytes);
+        return reinterpret_cast<void*>(start);
+    }
+
+    void deallocate(void* ptr, size_t bytes)
+    {
+        if (static_cast<char*>(ptr) + bytes == m_cursor)
+            m_cursor = static_cast<char*>(ptr);
+    }
+
+    void release()
+    {
+        while (m_chunks)
+            ::operator delete(std::exchange(m_chunks, m_chunks->next));
+
+        m_cursor = m_end = nullptr;
+    }
+};
+
+// Allocates from an Arena it does not own. Like the std::pmr allocators,
+// it does not propagate on copy, move or swap: a Vector stays in the arena
+// it was built with, and copies start in the same arena as their source.
+template <class T>
+class ArenaAllocator
+{
+private:
+    Arena* m_arena;
+
+    template <class U>
+    friend class ArenaAllocator;
+
+public:
+    using value_type                             = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap            = std::false_type;
+
+    explicit ArenaAllocator(Arena& arena)
+        : m_arena{ &arena }
+    {}
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other)
+        : m_arena{ other.m_arena }
+    {}
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T* ptr, size_t n)
+    {
+        m_arena->deallocate(ptr, n * sizeof(T));
+    }
+    Arena* arena() const { return m_arena; }
+
+    template <class U>
+    friend bool
+        operator==(const ArenaAllocator& lhs, const ArenaAllocator<U>& rhs)
+    {
+        return lhs.m_arena == rhs.m_arena;
+    }
+};
+
+// Per-thread free list of BlockBytes-sized blocks. Blocks are individually
+// allocated, so one freed on a different thread just joins that thread's
+// list; whatever is cached is released when the thread exits. Blocks
+// freed after that (by a static or thread_local container destroyed
+// later) go straight to operator delete.
+template <size_t BlockBytes>
+class FixedPool
+{
+private:
+    struct Node
+    {
+        Node* next;
+    };
+
+    static constexpr size_t max_cached = 1024;
+
+    Node*  m_head{ nullptr };
+    size_t m_cached{ 0 };
+    size_t m_misses{ 0 };
+
+    // Trivially destructible, so still readable once the pool is gone.
+    static inline thread_local bool t_destroyed{ false };
+
+    FixedPool() = default;
+
+public:
+    FixedPool(const FixedPool&)            = delete;
+    FixedPool& operator=(const FixedPool&) = delete;
+    ~FixedPool()
+    {
+        t_destroyed = true;
+        while (m_head)
+            ::operator delete(std::exchange(m_head, m_head->next));
+    }
+
+    // The calling thread's pool, or null once it has been destroyed at
+    // thread exit.
+    static FixedPool* local()
+    {
+        if (t_destroyed)
+            return nullptr;
+
+        thread_local FixedPool pool;
+        return &pool;
+    }
+
+    void* allocate()
+    {
+        if (!m_head)
+        {
+            ++m_misses;
+            return ::operator new(BlockBytes);
+        }
+
+        --m_cached;
+        return std::exchange(m_head, m_head->next);
+    }
+
+    void deallocate(void* ptr)
+    {
+        if (m_cached == max_cached)
+            return ::operator delete(ptr);
+
+        m_head = new (ptr) Node{ m_head };
+        ++m_cached;
+    }
+
+    size_t misses() const { return m_misses; }
+};
+
+// Stateless allocator serving requests of up to BlockBytes from the calling
+// thread's FixedPool; larger requests go to operator new.
+template <class T, size_t BlockBytes = 256>
+struct PoolAllocator
+{
+    static_assert(BlockBytes >= sizeof(void*));
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+    using value_type      = T;
+    using is_always_equal = std::true_type;
+    using Pool            = FixedPool<BlockBytes>;
+
+    template <class U>
+    struct rebind
+    {
+        using other = PoolAllocator<U, BlockBytes>;
+    };
+
+    PoolAllocator() = default;
+    template <class U>
+    PoolAllocator(const PoolAllocator<U, BlockBytes>&)
+    {}
 
-template <class T, class Allocator = std::allocator<T>>
+    T* allocate(size_t n)
+    {
+        if (n * sizeof(T) > BlockBytes)
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        if (Pool* pool = Pool::local())
+            return static_cast<T*>(pool->allocate());
+        return static_cast<T*>(::operator new(BlockBytes));
+    }
+
+    void deallocate(T* ptr, size_t n)
+    {
+        if (n * sizeof(T) > BlockBytes)
+            return ::operator delete(ptr);
+        if (Pool* pool = Pool::local())
+            return pool->deallocate(ptr);
+        ::operator delete(ptr);
+    }
+
+    friend bool operator==(const PoolAllocator&, const PoolAllocator&)
+    {
+        return true;
+    }
+};
+
+template <
+    class T,
+    class Allocator = std::allocator<T>,
+    class Growth    = DoublingGrowth>
 class Vector
 {
 private:
@@ -12,6 +430,40 @@ private:
     T*        m_data{ nullptr };
     Allocator m_allocator{};
 
+    static constexpr bool relocatable = is_trivially_relocatable_v<T>;
+
+    // With the default allocator, relocatable buffers are managed with
+    // malloc/realloc so growth can extend in place (or via mremap for
+    // large blocks) instead of copying.
+    static constexpr bool uses_realloc =
+        relocatable && std::is_same_v<Allocator, std::allocator<T>> &&
+        alignof(T) <= alignof(std::max_align_t);
+
+    // The malloc/realloc path must reject sizes std::allocator would.
+    static void check_length(size_t capacity)
+    {
+        if (capacity > SIZE_MAX / sizeof(T))
+            throw std::bad_array_new_length{};
+    }
+
+    T* allocate(size_t capacity)
+    {
+        if constexpr (uses_realloc)
+        {
+            check_length(capacity);
+            void* ptr = std::malloc(capacity * sizeof(T));
+            if (!ptr)
+                throw std::bad_alloc{};
+            return static_cast<T*>(ptr);
+        }
+        else
+        {
+            return std::allocator_traits<Allocator>::allocate(
+                m_allocator, capacity
+            );
+        }
+    }
+
     void deallocate()
     {
         using Traits = std::allocator_traits<Allocator>;
@@ -19,106 +471,433 @@ private:
         {
             Traits::destroy(m_allocator, m_data + i);
         }
-        Traits::deallocate(m_allocator, m_data, m_capacity);
+
+        if constexpr (uses_realloc)
+            std::free(m_data);
+        else if (m_data)
+            Traits::deallocate(m_allocator, m_data, m_capacity);
     }
 
     void try_increase_capacity()
     {
         if (m_size == m_capacity)
-            reserve(m_capacity == 0 ? 1 : m_capacity * 2);
+            reserve(Growth::next_capacity(m_capacity, m_size + 1, sizeof(T)));
+    }
+
+    // Makes room for count more elements with at most one reallocation.
+    void grow_for(size_t count)
+    {
+        if (m_size + count > m_capacity)
+            reserve(
+                Growth::next_capacity(m_capacity, m_size + count, sizeof(T))
+            );
+    }
+
+    // Constructs count elements past the end; on failure the ones already
+    // built are destroyed and the size is left unchanged.
+    template <class Construct>
+    void construct_tail(size_t count, Construct construct)
+    {
+        using Traits = std::allocator_traits<Allocator>;
+        T*     tail  = m_data + m_size;
+        size_t i     = 0;
+
+        try
+        {
+            for (; i < count; ++i)
+                construct(tail + i, i);
+        }
+        catch (...)
+        {
+            for (size_t j{ 0 }; j < i; ++j)
+                Traits::destroy(m_allocator, tail + j);
+
+            throw;
+        }
+
+        m_size += count;
+    }
+
+    void release_storage()
+    {
+        deallocate();
+        m_data     = nullptr;
+        m_size     = 0;
+        m_capacity = 0;
+    }
+
+    void steal(Vector& other) noexcept
+    {
+        m_data     = std::exchange(other.m_data, nullptr);
+        m_size     = std::exchange(other.m_size, 0);
+        m_capacity = std::exchange(other.m_capacity, 0);
+    }
+
+    void destroy_tail(size_t size)
+    {
+        using Traits = std::allocator_traits<Allocator>;
+        for (size_t i{ size }; i < m_size; ++i)
+            Traits::destroy(m_allocator, m_data + i);
+
+        m_size = size;
     }
 
 public:
-    explicit Vector(size_t size, const T& value);
-    Vector(const std::initializer_list<T> values);
-    Vector(const Vector& other)                = delete;
-    Vector& operator=(const Vector& other)     = delete;
-    Vector(Vector&& other) noexcept            = delete;
-    Vector& operator=(Vector&& other) noexcept = delete;
+    Vector() = default;
+    explicit Vector(const Allocator& allocator);
+    explicit Vector(
+        size_t size, const T& value, const Allocator& allocator = Allocator()
+    );
+    Vector(
+        const std::initializer_list<T> values,
+        const Allocator&               allocator = Allocator()
+    );
+    Vector(const Vector& other);
+    Vector& operator=(const Vector& other);
+    Vector(Vector&& other) noexcept;
+    Vector& operator=(Vector&& other) noexcept(
+        std::allocator_traits<
+            Allocator>::propagate_on_container_move_assignment::value ||
+        std::allocator_traits<Allocator>::is_always_equal::value
+    );
     ~Vector();
 
     void reserve(size_t capacity);
     void push_back(const T& value);
     template <class... Args>
-    void      emplace_back(Args&&... args);
-    void      clear();
-    size_t    size() const { return m_size; }
-    size_t    capacity() const { return m_capacity; }
-    T*        data() { return m_data; }
-    Allocator get_allocator() const { return m_allocator; }
+    void emplace_back(Args&&... args);
+    template <class InputIt>
+    void append(InputIt first, InputIt last);
+    void append(std::span<const T> values);
+    template <class InputIt>
+    void assign(InputIt first, InputIt last);
+    void assign(std::span<const T> values);
+    void resize(size_t size);
+    void resize(size_t size, const T& value);
+    void resize(size_t size, default_init_t);
+    // Grows by count default-initialized elements and returns them for the
+    // caller (e.g. a read() call) to fill in.
+    std::span<T> append_uninitialized(size_t count);
+    void         clear();
+    size_t       size() const { return m_size; }
+    size_t       capacity() const { return m_capacity; }
+    T*           data() { return m_data; }
+    const T*     data() const { return m_data; }
+    Allocator    get_allocator() const { return m_allocator; }
+
+    void swap(Vector& other) noexcept;
+    friend void swap(Vector& lhs, Vector& rhs) noexcept { lhs.swap(rhs); }
 };
 
-template <typename T, typename Allocator>
-Vector<T, Allocator>::Vector(size_t size, const T& value)
-{
-    reserve(size);
+template <typename T, typename Allocator, typename Growth>
+Vector<T, Allocator, Growth>::Vector(const Allocator& allocator)
+    : m_allocator{ allocator }
+{}
 
-    for (size_t i{}; i < size; ++i)
-        push_back(value);
+template <typename T, typename Allocator, typename Growth>
+Vector<T, Allocator, Growth>::Vector(
+    size_t size, const T& value, const Allocator& allocator
+)
+    : m_allocator{ allocator }
+{
+    resize(size, value);
 }
 
-template <typename T, typename Allocator>
-Vector<T, Allocator>::Vector(const std::initializer_list<T> values)
+template <typename T, typename Allocator, typename Growth>
+Vector<T, Allocator, Growth>::Vector(
+    const std::initializer_list<T> values, const Allocator& allocator
+)
+    : m_allocator{ allocator }
 {
-    reserve(values.size());
-
-    for (const auto& value : values)
-        push_back(value);
+    append(values.begin(), values.end());
 }
 
-template <typename T, typename Allocator>
-void Vector<T, Allocator>::reserve(size_t capacity)
+template <typename T, typename Allocator, typename Growth>
+void Vector<T, Allocator, Growth>::reserve(size_t capacity)
 {
     using Traits = std::allocator_traits<Allocator>;
     if (capacity <= m_capacity)
         return;
 
-    T*     newData = Traits::allocate(m_allocator, capacity);
-    size_t i       = 0;
+    if constexpr (uses_realloc)
+    {
+        check_length(capacity);
+        void* newData =
+            std::realloc(static_cast<void*>(m_data), capacity * sizeof(T));
+        if (!newData)
+            throw std::bad_alloc{};
 
-    try
+        m_data     = static_cast<T*>(newData);
+        m_capacity = capacity;
+    }
+    else if constexpr (relocatable)
     {
-        for (; i < m_size; ++i)
-            Traits::construct(m_allocator, newData + i, std::move(m_data[i]));
+        T* newData = allocate(capacity);
+        if (m_size != 0)
+            std::memcpy(
+                static_cast<void*>(newData), m_data, m_size * sizeof(T)
+            );
+
+        // The elements now live in newData; release the old storage only.
+        if (m_data)
+            Traits::deallocate(m_allocator, m_data, m_capacity);
+        m_data     = newData;
+        m_capacity = capacity;
     }
-    catch (...)
+    else
     {
-        for (size_t j{ 0 }; j < i; ++j)
-            Traits::destroy(m_allocator, newData + j);
+        T*     newData = allocate(capacity);
+        size_t i       = 0;
 
-        Traits::deallocate(m_allocator, newData, capacity);
+        try
+        {
+            for (; i < m_size; ++i)
+                Traits::construct(
+                    m_allocator, newData + i, std::move(m_data[i])
+                );
+        }
+        catch (...)
+        {
+            for (size_t j{ 0 }; j < i; ++j)
+                Traits::destroy(m_allocator, newData + j);
+
+            Traits::deallocate(m_allocator, newData, capacity);
+
+            throw;
+        }
+
+        deallocate();   // Destroy + deallocate old data
+        m_data     = newData;
+        m_capacity = capacity;
+    }
+}
 
-        throw;
+template <typename T, typename Allocator, typename Growth>
+Vector<T, Allocator, Growth>::Vector(const Vector& other)
+    : m_allocator{ std::allocator_traits<Allocator>::
+                       select_on_container_copy_construction(other.m_allocator)
+      }
+{
+    append(other.m_data, other.m_data + other.m_size);
+}
+
+template <typename T, typename Allocator, typename Growth>
+Vector<T, Allocator, Growth>&
+    Vector<T, Allocator, Growth>::operator=(const Vector& other)
+{
+    using Traits = std::allocator_traits<Allocator>;
+    if (this == &other)
+        return *this;
+
+    if constexpr (Traits::propagate_on_container_copy_assignment::value)
+    {
+        // Memory from the old allocator must go back to it.
+        if (m_allocator != other.m_allocator)
+            release_storage();
+        m_allocator = other.m_allocator;
     }
 
-    deallocate();   // Destroy + deallocate old data
-    m_data     = newData;
-    m_capacity = capacity;
+    // Reuses the current buffer when it is large enough.
+    assign(other.m_data, other.m_data + other.m_size);
+    return *this;
+}
+
+template <typename T, typename Allocator, typename Growth>
+Vector<T, Allocator, Growth>::Vector(Vector&& other) noexcept
+    : m_allocator{ std::move(other.m_allocator) }
+{
+    steal(other);
+}
+
+template <typename T, typename Allocator, typename Growth>
+Vector<T, Allocator, Growth>&
+    Vector<T, Allocator, Growth>::operator=(Vector&& other) noexcept(
+        std::allocator_traits<
+            Allocator>::propagate_on_container_move_assignment::value ||
+        std::allocator_traits<Allocator>::is_always_equal::value
+    )
+{
+    using Traits = std::allocator_traits<Allocator>;
+    if (this == &other)
+        return *this;
+
+    if constexpr (Traits::propagate_on_container_move_assignment::value)
+    {
+        release_storage();
+        m_allocator = std::move(other.m_allocator);
+        steal(other);
+    }
+    else
+    {
+        if (m_allocator == other.m_allocator)
+        {
+            release_storage();
+            steal(other);
+        }
+        else
+        {
+            // Different, non-propagating allocators cannot share a buffer;
+            // move the elements into our own storage instead.
+            assign(
+                std::make_move_iterator(other.m_data),
+                std::make_move_iterator(other.m_data + other.m_size)
+            );
+            other.clear();
+        }
+    }
+    return *this;
 }
 
-template <typename T, typename Allocator>
-Vector<T, Allocator>::~Vector()
+template <typename T, typename Allocator, typename Growth>
+Vector<T, Allocator, Growth>::~Vector()
 {
     deallocate();
 }
 
-template <typename T, typename Allocator>
-void Vector<T, Allocator>::push_back(const T& value)
+template <typename T, typename Allocator, typename Growth>
+void Vector<T, Allocator, Growth>::push_back(const T& value)
 {
     try_increase_capacity();
     new (m_data + m_size++) T{ value };
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename Growth>
 template <typename... Args>
-void Vector<T, Allocator>::emplace_back(Args&&... args)
+void Vector<T, Allocator, Growth>::emplace_back(Args&&... args)
 {
     try_increase_capacity();
     new (m_data + m_size++) T(std::forward<Args>(args)...);
 }
 
-template <typename T, typename Allocator>
-void Vector<T, Allocator>::clear()
+template <typename T, typename Allocator, typename Growth>
+template <typename InputIt>
+void Vector<T, Allocator, Growth>::append(InputIt first, InputIt last)
+{
+    using Traits = std::allocator_traits<Allocator>;
+    using Source = std::iter_value_t<InputIt>;
+
+    if constexpr (!std::forward_iterator<InputIt>)
+    {
+        for (; first != last; ++first)
+            emplace_back(*first);
+    }
+    else if constexpr (std::contiguous_iterator<InputIt> &&
+                       std::is_same_v<std::remove_cv_t<Source>, T> &&
+                       std::is_trivially_copyable_v<T>)
+    {
+        size_t count = static_cast<size_t>(std::distance(first, last));
+        grow_for(count);
+        if (count != 0)
+            std::memcpy(
+                static_cast<void*>(m_data + m_size), std::to_address(first),
+                count * sizeof(T)
+            );
+        m_size += count;
+    }
+    else
+    {
+        size_t count = static_cast<size_t>(std::distance(first, last));
+        grow_for(count);
+        construct_tail(
+            count,
+            [&](T* ptr, size_t)
+            {
+                Traits::construct(m_allocator, ptr, *first);
+                ++first;
+            }
+        );
+    }
+}
+
+template <typename T, typename Allocator, typename Growth>
+void Vector<T, Allocator, Growth>::append(std::span<const T> values)
+{
+    append(values.begin(), values.end());
+}
+
+template <typename T, typename Allocator, typename Growth>
+template <typename InputIt>
+void Vector<T, Allocator, Growth>::assign(InputIt first, InputIt last)
+{
+    clear();
+    append(first, last);
+}
+
+template <typename T, typename Allocator, typename Growth>
+void Vector<T, Allocator, Growth>::assign(std::span<const T> values)
+{
+    assign(values.begin(), values.end());
+}
+
+template <typename T, typename Allocator, typename Growth>
+void Vector<T, Allocator, Growth>::resize(size_t size)
+{
+    using Traits = std::allocator_traits<Allocator>;
+    if (size <= m_size)
+        return destroy_tail(size);
+
+    size_t count = size - m_size;
+    grow_for(count);
+    if constexpr (std::is_trivially_default_constructible_v<T>)
+    {
+        std::memset(
+            static_cast<void*>(m_data + m_size), 0, count * sizeof(T)
+        );
+        m_size = size;
+    }
+    else
+    {
+        construct_tail(
+            count, [&](T* ptr, size_t) { Traits::construct(m_allocator, ptr); }
+        );
+    }
+}
+
+template <typename T, typename Allocator, typename Growth>
+void Vector<T, Allocator, Growth>::resize(size_t size, const T& value)
+{
+    using Traits = std::allocator_traits<Allocator>;
+    if (size <= m_size)
+        return destroy_tail(size);
+
+    // value may be one of our own elements, which growing would free.
+    if (size > m_capacity)
+    {
+        T copy(value);
+        grow_for(size - m_size);
+        return resize(size, copy);
+    }
+
+    construct_tail(
+        size - m_size,
+        [&](T* ptr, size_t) { Traits::construct(m_allocator, ptr, value); }
+    );
+}
+
+template <typename T, typename Allocator, typename Growth>
+void Vector<T, Allocator, Growth>::resize(size_t size, default_init_t)
+{
+    if (size <= m_size)
+        return destroy_tail(size);
+
+    size_t count = size - m_size;
+    grow_for(count);
+    if constexpr (std::is_trivially_default_constructible_v<T>)
+        m_size = size;
+    else
+        construct_tail(count, [](T* ptr, size_t) { new (ptr) T; });
+}
+
+template <typename T, typename Allocator, typename Growth>
+std::span<T> Vector<T, Allocator, Growth>::append_uninitialized(size_t count)
+{
+    size_t offset = m_size;
+    resize(m_size + count, default_init);
+    return { m_data + offset, count };
+}
+
+template <typename T, typename Allocator, typename Growth>
+void Vector<T, Allocator, Growth>::clear()
 {
     using Traits = std::allocator_traits<Allocator>;
     for (size_t i{ 0 }; i < m_size; ++i)
@@ -127,6 +906,364 @@ void Vector<T, Allocator>::clear()
     m_size = 0;
 }
 
+template <typename T, typename Allocator, typename Growth>
+void Vector<T, Allocator, Growth>::swap(Vector& other) noexcept
+{
+    using Traits = std::allocator_traits<Allocator>;
+    if constexpr (Traits::propagate_on_container_swap::value)
+    {
+        using std::swap;
+        swap(m_allocator, other.m_allocator);
+    }
+    else
+    {
+        assert(m_allocator == other.m_allocator);
+    }
+
+    std::swap(m_data, other.m_data);
+    std::swap(m_size, other.m_size);
+    std::swap(m_capacity, other.m_capacity);
+}
+
+// Stores its first N elements inline and only spills into a Vector (and
+// its allocator) once it grows past N.
+template <
+    class T,
+    size_t N,
+    class Allocator = std::allocator<T>,
+    class Growth    = DoublingGrowth>
+class SmallVector
+{
+    static_assert(N > 0, "SmallVector needs a non-zero inline capacity");
+
+private:
+    size_t                       m_size{};   // Elements held inline
+    alignas(T) unsigned char     m_buffer[N * sizeof(T)];
+    Vector<T, Allocator, Growth> m_heap{};
+
+    bool is_inline() const { return m_heap.capacity() == 0; }
+    T*   inline_data() { return std::launder(reinterpret_cast<T*>(m_buffer)); }
+    const T* inline_data() const
+    {
+        return std::launder(reinterpret_cast<const T*>(m_buffer));
+    }
+
+    void destroy_inline()
+    {
+        std::destroy_n(inline_data(), m_size);
+        m_size = 0;
+    }
+
+    void spill(size_t capacity)
+    {
+        m_heap.reserve(capacity);
+        for (size_t i{ 0 }; i < m_size; ++i)
+            m_heap.emplace_back(std::move(inline_data()[i]));
+
+        destroy_inline();
+    }
+
+    void copy_from(const SmallVector& other)
+    {
+        reserve(other.size());
+        const T* source = other.data();
+        for (size_t i{ 0 }; i < other.size(); ++i)
+            emplace_back(source[i]);
+    }
+
+    void move_inline_from(SmallVector& other)
+    {
+        reserve(other.m_size);
+        for (size_t i{ 0 }; i < other.m_size; ++i)
+            emplace_back(std::move(other.inline_data()[i]));
+
+        other.destroy_inline();
+    }
+
+    // Exchanges the inline elements only; a spilled vector has none.
+    void swap_inline(SmallVector& other) noexcept(
+        std::is_nothrow_move_constructible_v<T> &&
+        std::is_nothrow_swappable_v<T>
+    )
+    {
+        SmallVector& shorter = m_size < other.m_size ? *this : other;
+        SmallVector& longer  = m_size < other.m_size ? other : *this;
+        T*           from    = longer.inline_data();
+        T*           to      = shorter.inline_data();
+
+        using std::swap;
+        for (size_t i{ 0 }; i < shorter.m_size; ++i)
+            swap(to[i], from[i]);
+        for (size_t i{ shorter.m_size }; i < longer.m_size; ++i)
+            new (to + i) T(std::move(from[i]));
+
+        std::destroy(from + shorter.m_size, from + longer.m_size);
+        std::swap(m_size, other.m_size);
+    }
+
+    void try_increase_capacity()
+    {
+        if (is_inline() && m_size == N)
+            spill(Growth::next_capacity(N, N + 1, sizeof(T)));
+    }
+
+public:
+    SmallVector() = default;
+    explicit SmallVector(const Allocator& allocator)
+        : m_heap{ allocator }
+    {}
+    explicit SmallVector(size_t size, const T& value);
+    SmallVector(const std::initializer_list<T> values);
+    SmallVector(const SmallVector& other);
+    SmallVector& operator=(const SmallVector& other);
+    // noexcept when T's move is (and, for assignment, the heap Vector's),
+    // so containers of SmallVector move them rather than copy on growth.
+    SmallVector(SmallVector&& other) noexcept(
+        std::is_nothrow_move_constructible_v<T>
+    );
+    SmallVector& operator=(SmallVector&& other) noexcept(
+        std::is_nothrow_move_constructible_v<T> &&
+        std::is_nothrow_move_assignable_v<Vector<T, Allocator, Growth>>
+    );
+    ~SmallVector() { destroy_inline(); }
+
+    void reserve(size_t capacity);
+    void push_back(const T& value);
+    template <class... Args>
+    void   emplace_back(Args&&... args);
+    void   clear();
+    size_t size() const { return is_inline() ? m_size : m_heap.size(); }
+    size_t capacity() const { return is_inline() ? N : m_heap.capacity(); }
+    T*     data() { return is_inline() ? inline_data() : m_heap.data(); }
+    const T* data() const
+    {
+        return is_inline() ? inline_data() : m_heap.data();
+    }
+    Allocator get_allocator() const { return m_heap.get_allocator(); }
+
+    void swap(SmallVector& other) noexcept(
+        std::is_nothrow_move_constructible_v<T> &&
+        std::is_nothrow_swappable_v<T>
+    );
+    friend void swap(SmallVector& lhs, SmallVector& rhs) noexcept(
+        noexcept(lhs.swap(rhs))
+    )
+    {
+        lhs.swap(rhs);
+    }
+};
+
+template <typename T, size_t N, typename Allocator, typename Growth>
+SmallVector<T, N, Allocator, Growth>::SmallVector(const SmallVector& other)
+    : m_heap{ std::allocator_traits<Allocator>::
+                  select_on_container_copy_construction(other.get_allocator()) }
+{
+    copy_from(other);
+}
+
+// Assignment and swap go through the heap Vector first, so the allocator
+// propagates (or is compared) exactly as it does for Vector; only then
+// are inline elements copied, moved or exchanged.
+template <typename T, size_t N, typename Allocator, typename Growth>
+SmallVector<T, N, Allocator, Growth>&
+    SmallVector<T, N, Allocator, Growth>::operator=(const SmallVector& other)
+{
+    if (this != &other)
+    {
+        clear();
+        m_heap = other.m_heap;
+        if (other.is_inline())
+            copy_from(other);
+    }
+    return *this;
+}
+
+// A spilled source hands over its heap buffer; inline elements have to be
+// moved one by one.
+template <typename T, size_t N, typename Allocator, typename Growth>
+SmallVector<T, N, Allocator, Growth>::SmallVector(SmallVector&& other)
+    noexcept(std::is_nothrow_move_constructible_v<T>)
+    : m_heap{ std::move(other.m_heap) }
+{
+    if (is_inline())
+        move_inline_from(other);
+}
+
+template <typename T, size_t N, typename Allocator, typename Growth>
+SmallVector<T, N, Allocator, Growth>&
+    SmallVector<T, N, Allocator, Growth>::operator=(SmallVector&& other)
+    noexcept(
+        std::is_nothrow_move_constructible_v<T> &&
+        std::is_nothrow_move_assignable_v<Vector<T, Allocator, Growth>>
+    )
+{
+    if (this == &other)
+        return *this;
+
+    bool sourceInline = other.is_inline();
+    clear();
+    m_heap = std::move(other.m_heap);
+    if (sourceInline)
+        move_inline_from(other);
+    return *this;
+}
+
+// The heap buffers swap like Vector's (including the allocators), which
+// leaves any inline elements where they were; those are exchanged next.
+template <typename T, size_t N, typename Allocator, typename Growth>
+void SmallVector<T, N, Allocator, Growth>::swap(SmallVector& other) noexcept(
+    std::is_nothrow_move_constructible_v<T> && std::is_nothrow_swappable_v<T>
+)
+{
+    m_heap.swap(other.m_heap);
+    swap_inline(other);
+}
+
+template <typename T, size_t N, typename Allocator, typename Growth>
+SmallVector<T, N, Allocator, Growth>::SmallVector(size_t size, const T& value)
+{
+    reserve(size);
+
+    for (size_t i{}; i < size; ++i)
+        push_back(value);
+}
+
+template <typename T, size_t N, typename Allocator, typename Growth>
+SmallVector<T, N, Allocator, Growth>::SmallVector(
+    const std::initializer_list<T> values
+)
+{
+    reserve(values.size());
+
+    for (const auto& value : values)
+        push_back(value);
+}
+
+template <typename T, size_t N, typename Allocator, typename Growth>
+void SmallVector<T, N, Allocator, Growth>::reserve(size_t capacity)
+{
+    if (!is_inline())
+        m_heap.reserve(capacity);
+    else if (capacity > N)
+        spill(capacity);
+}
+
+template <typename T, size_t N, typename Allocator, typename Growth>
+void SmallVector<T, N, Allocator, Growth>::push_back(const T& value)
+{
+    try_increase_capacity();
+    if (!is_inline())
+        return m_heap.push_back(value);
+
+    new (inline_data() + m_size) T{ value };
+    ++m_size;
+}
+
+template <typename T, size_t N, typename Allocator, typename Growth>
+template <typename... Args>
+void SmallVector<T, N, Allocator, Growth>::emplace_back(Args&&... args)
+{
+    try_increase_capacity();
+    if (!is_inline())
+        return m_heap.emplace_back(std::forward<Args>(args)...);
+
+    new (inline_data() + m_size) T(std::forward<Args>(args)...);
+    ++m_size;
+}
+
+template <typename T, size_t N, typename Allocator, typename Growth>
+void SmallVector<T, N, Allocator, Growth>::clear()
+{
+    if (is_inline())
+        destroy_inline();
+    else
+        m_heap.clear();
+}
+
+#endif   // VECTOR_CPP
+
+#ifndef VECTOR_NO_MAIN
+
+// Counts allocations so tests can observe when storage is requested.
+template <class T>
+struct CountingAllocator
+{
+    using value_type = T;
+
+    inline static size_t allocations{ 0 };
+
+    CountingAllocator() = default;
+    template <class U>
+    CountingAllocator(const CountingAllocator<U>&)
+    {}
+
+    T* allocate(size_t n)
+    {
+        ++allocations;
+        return std::allocator<T>{}.allocate(n);
+    }
+    void deallocate(T* ptr, size_t n)
+    {
+        std::allocator<T>{}.deallocate(ptr, n);
+    }
+
+    friend bool operator==(const CountingAllocator&, const CountingAllocator&)
+    {
+        return true;
+    }
+};
+
+// Allocators with an identity that follow their contents on copy, move
+// and swap, so tests can see where propagation happens.
+template <class T>
+struct PropagatingAllocator
+{
+    using value_type                             = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap            = std::true_type;
+
+    int id{ 0 };
+
+    PropagatingAllocator() = default;
+    explicit PropagatingAllocator(int id)
+        : id{ id }
+    {}
+    template <class U>
+    PropagatingAllocator(const PropagatingAllocator<U>& other)
+        : id{ other.id }
+    {}
+
+    T* allocate(size_t n) { return std::allocator<T>{}.allocate(n); }
+    void deallocate(T* ptr, size_t n)
+    {
+        std::allocator<T>{}.deallocate(ptr, n);
+    }
+
+    friend bool
+        operator==(const PropagatingAllocator&, const PropagatingAllocator&) =
+            default;
+};
+
+// Owns a heap int; relocating it bitwise is safe even though it is not
+// trivially copyable.
+struct OwnedInt
+{
+    int* ptr;
+    explicit OwnedInt(int value)
+        : ptr{ new int{ value } }
+    {}
+    OwnedInt(OwnedInt&& other) noexcept
+        : ptr{ std::exchange(other.ptr, nullptr) }
+    {}
+    ~OwnedInt() { delete ptr; }
+};
+
+template <>
+struct is_trivially_relocatable<OwnedInt> : std::true_type
+{};
+
+
 int main()
 {
     // Construct with size and value
@@ -186,6 +1323,23 @@ int main()
         assert(oldCap < v.capacity());
     }
 
+    {
+        // Oversized requests throw on the realloc path too, and leave the
+        // vector untouched.
+        Vector<int> v{ 1, 2, 3 };
+        bool        threw = false;
+        try
+        {
+            v.reserve(SIZE_MAX / sizeof(int) + 2);
+        }
+        catch (const std::bad_array_new_length&)
+        {
+            threw = true;
+        }
+        assert(threw);
+        assert(v.size() == 3 && v.capacity() < 100 && v.data()[2] == 3);
+    }
+
     {
         Vector<int> v{ 1, 2, 3 };
         v.clear();
@@ -219,4 +1373,337 @@ int main()
         assert(vf.data()[2].x == 5);
         assert(vf.data()[2].y == 6);
     }
+
+    {
+        // Trivially copyable growth takes the realloc path
+        Vector<double> v{ 0.5 };
+        for (int i = 0; i < 1000; ++i)
+            v.push_back(i);
+        assert(v.size() == 1001);
+        assert(v.data()[0] == 0.5);
+        assert(v.data()[1000] == 999);
+    }
+
+    {
+        // Specialized relocatable type grows with memcpy
+        Vector<OwnedInt> v;
+        for (int i = 0; i < 100; ++i)
+            v.emplace_back(i);
+        assert(v.size() == 100);
+        for (int i = 0; i < 100; ++i)
+            assert(*v.data()[i].ptr == i);
+    }
+
+    {
+        // SmallVector stays inline up to N elements
+        using Alloc = CountingAllocator<int>;
+        SmallVector<int, 4, Alloc> v{ 1, 2 };
+        v.emplace_back(3);
+        v.push_back(4);
+        assert(v.size() == 4);
+        assert(v.capacity() == 4);
+        assert(Alloc::allocations == 0);
+
+        // ...and spills to the allocator past N
+        v.push_back(5);
+        assert(Alloc::allocations == 1);
+        assert(v.size() == 5);
+        assert(v.capacity() >= 5);
+        for (int i = 0; i < 5; ++i)
+            assert(v.data()[i] == i + 1);
+
+        v.clear();
+        assert(v.size() == 0);
+        v.push_back(100);
+        assert(v.data()[0] == 100);
+    }
+
+    {
+        SmallVector<OwnedInt, 2> v;
+        v.reserve(2);
+        v.emplace_back(7);
+        v.emplace_back(8);
+        v.emplace_back(9);
+        assert(v.size() == 3);
+        assert(*v.data()[0].ptr == 7 && *v.data()[2].ptr == 9);
+    }
+    {
+        // Bulk append/assign from iterators and spans
+        Vector<int> v;
+        int         raw[]{ 1, 2, 3, 4 };
+        v.append(std::span<const int>{ raw });
+        v.append(raw, raw + 2);
+        assert(v.size() == 6);
+        assert(v.data()[4] == 1 && v.data()[5] == 2);
+
+        size_t oldCap = v.capacity();
+        v.assign(raw + 1, raw + 3);
+        assert(v.size() == 2);
+        assert(v.data()[0] == 2 && v.data()[1] == 3);
+        assert(v.capacity() == oldCap);
+
+        std::initializer_list<long> wide{ 7, 8 };
+        v.append(wide.begin(), wide.end());
+        assert(v.size() == 4 && v.data()[3] == 8);
+    }
+
+    {
+        // resize modes
+        Vector<int> v{ 5 };
+        v.resize(4);
+        assert(v.size() == 4);
+        assert(v.data()[0] == 5 && v.data()[3] == 0);
+
+        v.resize(6, 9);
+        assert(v.data()[5] == 9);
+
+        v.resize(2);
+        assert(v.size() == 2);
+
+        v.resize(10, default_init);
+        assert(v.size() == 10);
+        assert(v.data()[1] == 0);
+    }
+
+    {
+        // append_uninitialized hands out writable storage
+        Vector<char> v;
+        auto         chunk = v.append_uninitialized(5);
+        assert(chunk.size() == 5);
+        std::memcpy(chunk.data(), "hello", 5);
+        assert(v.size() == 5);
+        assert(std::memcmp(v.data(), "hello", 5) == 0);
+    }
+
+    {
+        // Non-trivial elements go through construct one by one
+        Vector<std::string> v;
+        std::string         words[]{ "a", "b" };
+        v.append(std::span<const std::string>{ words });
+        v.resize(3);
+        assert(v.size() == 3 && v.data()[1] == "b" && v.data()[2].empty());
+        v.resize(1);
+        assert(v.size() == 1);
+
+        // Resizing from an element of the same vector past its capacity
+        v.data()[0] = "a string too long for the small-string buffer";
+        v.resize(v.capacity() * 2 + 1, v.data()[0]);
+        for (size_t i = 0; i < v.size(); ++i)
+            assert(v.data()[i] == v.data()[0]);
+    }
+    {
+        // Growth policies
+        Vector<int, std::allocator<int>, OneAndHalfGrowth> v;
+        size_t caps[8]{};
+        for (int i = 0, n = 0; n < 8; ++i)
+        {
+            size_t before = v.capacity();
+            v.push_back(i);
+            if (v.capacity() != before)
+                caps[n++] = v.capacity();
+        }
+        assert(caps[0] == 1 && caps[1] == 2 && caps[2] == 3);
+        assert(caps[3] == 4 && caps[4] == 6 && caps[5] == 9);
+
+        using Chunked = ChunkedGrowth<64, DoublingGrowth>;   // 16 ints
+        assert(Chunked::next_capacity(8, 9, sizeof(int)) == 16);
+        assert(Chunked::next_capacity(16, 17, sizeof(int)) == 32);
+        assert(Chunked::next_capacity(32, 33, sizeof(int)) == 48);
+        assert(Chunked::next_capacity(48, 100, sizeof(int)) == 112);
+    }
+
+    {
+        // Buffers past the threshold come from huge-page backed mappings
+        Vector<int, HugePageAllocator<int>> v;
+        v.resize(1 << 20, 3);
+        assert(v.size() == 1 << 20);
+        assert(v.data()[0] == 3 && v.data()[(1 << 20) - 1] == 3);
+        assert(
+            reinterpret_cast<std::uintptr_t>(v.data()) %
+                HugePageAllocator<int>::huge_page_size ==
+            0
+        );
+
+        SmallVector<int, 2, HugePageAllocator<int>> small{ 1, 2, 3 };
+        assert(small.size() == 3);
+
+        // Sizes whose byte count or rounded mapping would wrap are refused
+        for (size_t n : { SIZE_MAX / 2, SIZE_MAX / sizeof(int) })
+        {
+            bool threw = false;
+            try
+            {
+                HugePageAllocator<int>{}.allocate(n);
+            }
+            catch (const std::bad_array_new_length&)
+            {
+                threw = true;
+            }
+            assert(threw);
+        }
+    }
+    {
+        // Arena-backed vectors share one arena and release it in bulk
+        Arena arena;
+        {
+            using Alloc = ArenaAllocator<int>;
+            Vector<int, Alloc> a(Alloc{ arena });
+            Vector<int, Alloc> b(3, 7, Alloc{ arena });
+            for (int i = 0; i < 100; ++i)
+                a.push_back(i);
+            assert(a.size() == 100 && a.data()[99] == 99);
+            assert(b.data()[2] == 7);
+            assert(a.get_allocator().arena() == &arena);
+            assert(a.get_allocator() == b.get_allocator());
+
+            SmallVector<int, 4, Alloc> small(Alloc{ arena });
+            for (int i = 0; i < 10; ++i)
+                small.push_back(i);
+            assert(small.get_allocator().arena() == &arena);
+        }
+        arena.release();
+    }
+
+    {
+        // Short-lived pooled vectors recycle the same blocks
+        using Alloc = PoolAllocator<int>;
+        for (int round = 0; round < 100; ++round)
+        {
+            Vector<int, Alloc> v;
+            for (int i = 0; i < 32; ++i)
+                v.push_back(i);
+            assert(v.data()[31] == 31);
+        }
+        assert(Alloc::Pool::local()->misses() <= 2);
+
+        Vector<int, Alloc> large;
+        large.resize(1000, 1);
+        assert(large.data()[999] == 1);
+
+        // A thread_local vector constructed before the thread's pool is
+        // destroyed after it, and frees its block with the pool gone.
+        auto useLate = []
+        {
+            thread_local Vector<int, Alloc> late;
+            late.push_back(1);
+        };
+        std::thread{ useLate }.join();
+    }
+    {
+        // Copies are independent and copy assignment reuses capacity
+        using Alloc = CountingAllocator<int>;
+        Vector<int, Alloc> a{ 1, 2, 3 };
+        Vector<int, Alloc> b(a);
+        b.data()[0] = 10;
+        assert(a.data()[0] == 1 && b.size() == 3);
+
+        Vector<int, Alloc> c;
+        c.reserve(8);
+        size_t before = Alloc::allocations;
+        for (int i = 0; i < 10; ++i)
+            c = a;
+        assert(Alloc::allocations == before);
+        assert(c.size() == 3 && c.data()[2] == 3);
+    }
+
+    {
+        // Moves steal the buffer
+        auto make = []
+        {
+            Vector<std::string> v{ "x", "y" };
+            return v;
+        };
+        Vector<std::string> a = make();
+        const std::string*  buffer = a.data();
+        Vector<std::string> b(std::move(a));
+        assert(b.data() == buffer && b.size() == 2);
+        assert(a.size() == 0 && a.capacity() == 0);
+
+        Vector<std::string> c{ "z" };
+        c = std::move(b);
+        assert(c.data() == buffer && c.data()[1] == "y");
+
+        Vector<std::string> d{ "w" };
+        swap(c, d);
+        assert(d.data() == buffer && c.data()[0] == "w");
+    }
+
+    {
+        // Non-propagating allocators keep their arena on move assignment
+        Arena              first, second;
+        using Alloc = ArenaAllocator<int>;
+        Vector<int, Alloc> a({ 1, 2, 3 }, Alloc{ first });
+        Vector<int, Alloc> b(Alloc{ second });
+        b = std::move(a);
+        assert(b.get_allocator().arena() == &second);
+        assert(b.size() == 3 && b.data()[2] == 3);
+
+        Vector<int, Alloc> copy(b);
+        assert(copy.get_allocator().arena() == &second);
+    }
+
+    {
+        // SmallVector copies and moves both inline and spilled contents
+        SmallVector<std::string, 2> inlineVec{ "a" };
+        SmallVector<std::string, 2> spilled{ "a", "b", "c" };
+
+        SmallVector<std::string, 2> copy(spilled);
+        assert(copy.size() == 3 && copy.data()[2] == "c");
+
+        SmallVector<std::string, 2> moved(std::move(inlineVec));
+        assert(moved.size() == 1 && moved.data()[0] == "a");
+        assert(inlineVec.size() == 0);
+
+        moved = std::move(spilled);
+        assert(moved.size() == 3 && spilled.size() == 0);
+
+        swap(moved, copy);
+        copy = moved;
+        assert(copy.size() == 3 && copy.data()[1] == "b");
+    }
+
+    {
+        // SmallVector propagates allocators the way Vector does, whether
+        // the contents are inline or spilled
+        using Alloc = PropagatingAllocator<std::string>;
+        using Small = SmallVector<std::string, 2, Alloc>;
+
+        Small inlineVec(Alloc{ 1 });
+        inlineVec.push_back("a");
+        Small spilled(Alloc{ 2 });
+        for (const char* s : { "x", "y", "z" })
+            spilled.push_back(s);
+
+        Small copy(Alloc{ 3 });
+        copy = spilled;
+        assert(copy.get_allocator().id == 2 && copy.size() == 3);
+        copy = inlineVec;
+        assert(copy.get_allocator().id == 1 && copy.size() == 1);
+
+        Small moved(Alloc{ 4 });
+        moved = std::move(spilled);
+        assert(moved.get_allocator().id == 2 && moved.data()[2] == "z");
+
+        static_assert(noexcept(swap(moved, inlineVec)));
+        static_assert(std::is_nothrow_move_constructible_v<Small>);
+        static_assert(std::is_nothrow_move_assignable_v<Small>);
+        static_assert(
+            std::is_nothrow_move_constructible_v<SmallVector<std::string, 2>>
+        );
+        static_assert(
+            std::is_nothrow_move_assignable_v<SmallVector<std::string, 2>>
+        );
+        swap(moved, inlineVec);
+        assert(moved.get_allocator().id == 1 && moved.size() == 1);
+        assert(moved.data()[0] == "a");
+        assert(inlineVec.get_allocator().id == 2 && inlineVec.size() == 3);
+        assert(inlineVec.data()[0] == "x");
+
+        Small other(Alloc{ 1 });
+        other.push_back("b");
+        swap(moved, other);
+        assert(moved.data()[0] == "b" && other.data()[0] == "a");
+    }
 }
+
+#endif   // VECTOR_NO_MAIN